@@ -0,0 +1,88 @@
+#ifndef ROPE_BENCH_H
+#define ROPE_BENCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+
+/*
+ * Shared harness of the benchmark executables: heap accounting through a replaced global
+ * operator new, timing helpers and size parsing. Include it from exactly one translation unit.
+ */
+namespace bench {
+    inline std::atomic<std::size_t> live_bytes {0};
+    inline std::atomic<std::size_t> peak_bytes {0};
+
+    // Start a new peak measurement from what is allocated right now
+    inline auto resetPeak() -> std::size_t {
+        auto now = live_bytes.load(std::memory_order_relaxed);
+        peak_bytes.store(now, std::memory_order_relaxed);
+        return now;
+    }
+    inline auto peakSince(std::size_t baseline) -> std::size_t {
+        auto peak = peak_bytes.load(std::memory_order_relaxed);
+        return peak > baseline ? peak - baseline : 0;
+    }
+
+    // Every allocation carries its size in front, so unsized deletes can be accounted too
+    constexpr std::size_t header = alignof(std::max_align_t);
+
+    inline auto allocate(std::size_t size) -> void* {
+        auto raw = static_cast<unsigned char*>(std::malloc(size + header));
+        if (!raw) throw std::bad_alloc();
+        *reinterpret_cast<std::size_t*>(raw) = size;
+        auto now = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        auto peak = peak_bytes.load(std::memory_order_relaxed);
+        while (now > peak && !peak_bytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+        return raw + header;
+    }
+    inline void release(void *ptr) noexcept {
+        if (!ptr) return;
+        auto raw = static_cast<unsigned char*>(ptr) - header;
+        live_bytes.fetch_sub(*reinterpret_cast<std::size_t*>(raw), std::memory_order_relaxed);
+        std::free(raw);
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    inline auto nanoseconds(Clock::duration d) -> double {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    }
+
+    // "4096", "64K", "16M", "1G"
+    inline auto parseSize(std::string_view text) -> std::size_t {
+        std::size_t value = std::stoull(std::string(text));
+        switch (text.empty() ? '\0' : text.back()) {
+            case 'K': case 'k': return value << 10;
+            case 'M': case 'm': return value << 20;
+            case 'G': case 'g': return value << 30;
+            default: return value;
+        }
+    }
+    inline auto formatSize(std::size_t size) -> std::string {
+        if (size >= (std::size_t(1) << 30) && size % (std::size_t(1) << 30) == 0) return std::to_string(size >> 30) + "G";
+        if (size >= (std::size_t(1) << 20) && size % (std::size_t(1) << 20) == 0) return std::to_string(size >> 20) + "M";
+        if (size >= (std::size_t(1) << 10) && size % (std::size_t(1) << 10) == 0) return std::to_string(size >> 10) + "K";
+        return std::to_string(size);
+    }
+
+    // Keep the optimizer from dropping a computed value
+    template<typename T>
+    inline void keep(T &&value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+}
+
+auto operator new(std::size_t size) -> void* { return bench::allocate(size); }
+auto operator new[](std::size_t size) -> void* { return bench::allocate(size); }
+void operator delete(void *ptr) noexcept { bench::release(ptr); }
+void operator delete[](void *ptr) noexcept { bench::release(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { bench::release(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { bench::release(ptr); }
+
+#endif //ROPE_BENCH_H
@@ -0,0 +1,193 @@
+#ifndef ROPE_EDIT_TRACE_H
+#define ROPE_EDIT_TRACE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Editing traces shared by trace_replay and rope_autotune.
+ *
+ * Trace file (native byte order, every integer is a uint64):
+ *   "ROPETRC1", start length, start text, edit count,
+ *   edit count x (position, deleted characters, inserted length, inserted text),
+ *   has end flag, [end length, end text]
+ * Positions refer to the text after all previous edits; an end text, when present, is checked.
+ */
+namespace bench {
+    struct Edit {
+        std::size_t position;
+        std::size_t deleted;
+        std::string inserted;
+    };
+    struct EditTrace {
+        std::string name;
+        std::string start;
+        std::vector<Edit> edits;
+        std::optional<std::string> end;
+    };
+
+    inline constexpr char magic[] = "ROPETRC1";
+
+    inline void writeNumber(std::ofstream &out, std::uint64_t value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    inline void writeText(std::ofstream &out, const std::string &text) {
+        writeNumber(out, text.size());
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+    inline auto readNumber(std::ifstream &in) -> std::uint64_t {
+        std::uint64_t value;
+        if (!in.read(reinterpret_cast<char*>(&value), sizeof(value))) throw std::runtime_error("truncated trace");
+        return value;
+    }
+    inline auto readText(std::ifstream &in) -> std::string {
+        std::string text(readNumber(in), '\0');
+        if (!in.read(text.data(), static_cast<std::streamsize>(text.size()))) throw std::runtime_error("truncated trace");
+        return text;
+    }
+
+    inline void save(const EditTrace &trace, const std::string &path) {
+        std::ofstream out(path, std::ios::binary);
+        out.write(magic, sizeof(magic) - 1);
+        writeText(out, trace.start);
+        writeNumber(out, trace.edits.size());
+        for (auto &edit : trace.edits) {
+            writeNumber(out, edit.position);
+            writeNumber(out, edit.deleted);
+            writeText(out, edit.inserted);
+        }
+        writeNumber(out, trace.end.has_value());
+        if (trace.end) writeText(out, *trace.end);
+        if (!out) throw std::runtime_error("cannot write " + path);
+    }
+    inline auto load(const std::string &path) -> EditTrace {
+        std::ifstream in(path, std::ios::binary);
+        char header[sizeof(magic) - 1];
+        if (!in.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(header)) != 0)
+            throw std::runtime_error(path + " is not a trace file");
+        EditTrace trace{path, readText(in), {}, std::nullopt};
+        trace.edits.resize(readNumber(in));
+        for (auto &edit : trace.edits) {
+            edit.position = readNumber(in);
+            edit.deleted = readNumber(in);
+            edit.inserted = readText(in);
+        }
+        if (readNumber(in)) trace.end = readText(in);
+        return trace;
+    }
+
+    // Apply the edits to a std::string to record the expected end text
+    inline void seal(EditTrace &trace) {
+        std::string text = trace.start;
+        for (auto &edit : trace.edits) text.replace(edit.position, edit.deleted, edit.inserted);
+        trace.end = std::move(text);
+    }
+
+    inline auto words(std::mt19937 &rng, std::size_t size) -> std::string {
+        static constexpr const char *vocabulary[] = {"the", "rope", "string", "edit", "buffer", "line", "cursor", "text", "and", "of"};
+        std::string text;
+        while (text.size() < size) {
+            text += vocabulary[rng() % std::size(vocabulary)];
+            text += rng() % 12 ? ' ' : '\n';
+        }
+        text.resize(size);
+        return text;
+    }
+
+    // Typing session: characters at a cursor, backspaces and occasional cursor jumps
+    inline auto typing(std::size_t count) -> EditTrace {
+        std::mt19937 rng(1);
+        EditTrace trace{"typing", {}, {}, std::nullopt};
+        std::size_t size = 0, cursor = 0;
+        while (trace.edits.size() < count) {
+            auto roll = rng() % 100;
+            if (roll < 5 && size) {
+                cursor = rng() % (size + 1);
+            } else if (roll < 15 && cursor) {
+                trace.edits.push_back({--cursor, 1, ""});
+                --size;
+            } else {
+                trace.edits.push_back({cursor++, 0, std::string(1, rng() % 8 ? char('a' + rng() % 26) : ' ')});
+                ++size;
+            }
+        }
+        seal(trace);
+        return trace;
+    }
+    // Typing interleaved with pasting and cutting blocks of up to 64K
+    inline auto paste(std::size_t count) -> EditTrace {
+        std::mt19937 rng(2);
+        EditTrace trace{"paste", {}, {}, std::nullopt};
+        trace.start = words(rng, 64 << 10);
+        std::size_t size = trace.start.size(), cursor = size / 2;
+        while (trace.edits.size() < count) {
+            auto roll = rng() % 100;
+            if (roll < 4) {
+                auto block = words(rng, 1 + rng() % (64 << 10));
+                cursor = rng() % (size + 1);
+                trace.edits.push_back({cursor, 0, block});
+                size += block.size();
+                cursor += block.size();
+            } else if (roll < 8 && size) {
+                cursor = rng() % size;
+                auto cut = std::min<std::size_t>(size - cursor, 1 + rng() % (64 << 10));
+                trace.edits.push_back({cursor, cut, ""});
+                size -= cut;
+            } else {
+                trace.edits.push_back({cursor++, 0, std::string(1, char('a' + rng() % 26))});
+                ++size;
+            }
+        }
+        seal(trace);
+        return trace;
+    }
+    // Find-and-replace over a 4M document: every occurrence of a word, front to back, several passes
+    inline auto replace(std::size_t count) -> EditTrace {
+        std::mt19937 rng(3);
+        EditTrace trace{"replace", {}, {}, std::nullopt};
+        trace.start = words(rng, 4 << 20);
+        std::string text = trace.start;
+        const std::pair<std::string, std::string> passes[] = {{"rope", "cord"}, {"cord", "rope-string"}, {"rope-string", "r"}, {"r", "rope"}};
+        for (std::size_t pass = 0; trace.edits.size() < count; ++pass) {
+            auto &[from, to] = passes[pass % std::size(passes)];
+            for (auto at = text.find(from); at != std::string::npos && trace.edits.size() < count; at = text.find(from, at + to.size())) {
+                trace.edits.push_back({at, from.size(), to});
+                text.replace(at, from.size(), to);
+            }
+        }
+        trace.end = std::move(text);
+        return trace;
+    }
+
+    inline auto generate(const std::string &kind, std::size_t count) -> EditTrace {
+        if (kind == "typing") return typing(count);
+        if (kind == "paste") return paste(count);
+        if (kind == "replace") return replace(count);
+        throw std::runtime_error("unknown trace kind " + kind);
+    }
+
+
+    // Apply one edit to any string with erase(pos, count) and insert(pos, data, count)
+    template<typename S>
+    void apply(S &s, const Edit &edit) {
+        if (edit.deleted) s.erase(edit.position, edit.deleted);
+        if (!edit.inserted.empty()) s.insert(edit.position, edit.inserted.data(), edit.inserted.size());
+    }
+    // Expected end text, replaying on a std::string when the trace does not record one
+    inline auto expectedEnd(const EditTrace &trace) -> std::string {
+        if (trace.end) return *trace.end;
+        EditTrace copy = trace;
+        seal(copy);
+        return *copy.end;
+    }
+}
+#endif //ROPE_EDIT_TRACE_H
@@ -0,0 +1,134 @@
+/*
+ * Recommends chunk sizes for a workload: replays it on ropes of every candidate Rope::ChunkPolicy
+ * and ranks them by time and peak heap.
+ *
+ *   rope_autotune [typing|paste|replace|<trace file>]... [--edits 10000] [--lookups 100000]
+ *                 [--scans 4] [--memory-weight 0.25]
+ *
+ * A workload is one or more editing traces (synthetic kinds or files, see edit_trace.h), followed
+ * on the edited text by --lookups random operator[] reads and --scans full copies.
+ * score = time / best time + memory-weight * peak / best peak, lower is better.
+ */
+#include "bench.h"
+#include "edit_trace.h"
+#include <RopeString.h>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    struct Options {
+        std::vector<std::string> traces;
+        std::size_t edits = 10000;
+        std::size_t lookups = 100000;
+        std::size_t scans = 4;
+        double memory_weight = 0.25;
+    };
+
+    struct Result {
+        std::size_t leaf_size;
+        std::size_t root_size;
+        double milliseconds = 0;
+        std::size_t peak_bytes = 0;
+        double score = 0;
+    };
+
+    // Leaf sizes 16 ... 1024, each with roots of 4, 16 and 64 leaves
+    constexpr auto candidates = [] {
+        std::array<std::pair<std::size_t, std::size_t>, 21> result {};
+        std::size_t i = 0;
+        for (std::size_t leaf = 16; leaf <= 1024; leaf *= 2)
+            for (std::size_t leaves : {4, 16, 64}) result[i++] = {leaf, leaf * leaves};
+        return result;
+    }();
+
+    template<std::size_t Leaf, std::size_t Root>
+    auto run(const Options &options, const std::vector<bench::EditTrace> &workload) -> Result {
+        using S = Rope::BasicString<char, std::char_traits<char>, std::allocator<char>, Rope::ChunkPolicy<Leaf, Root>>;
+        Result result{Leaf, Root};
+        for (auto &trace : workload) {
+            auto baseline = bench::resetPeak();
+            {
+                S s(trace.start.data(), trace.start.size());
+                auto start = bench::Clock::now();
+                for (auto &edit : trace.edits) bench::apply(s, edit);
+                unsigned sum = 0;
+                for (std::size_t i = 0; i < options.lookups && !s.empty(); ++i)
+                    sum += static_cast<unsigned char>(s[(i * 2654435761u) % s.size()]);
+                std::string flat(s.size(), '\0');
+                for (std::size_t i = 0; i < options.scans; ++i) s.copy(flat.data(), flat.size());
+                bench::keep(sum);
+                result.milliseconds += bench::nanoseconds(bench::Clock::now() - start) / 1e6;
+                s.copy(flat.data(), flat.size());
+                if (flat != *trace.end) throw std::runtime_error("policy " + std::to_string(Leaf) + "/" + std::to_string(Root) + " diverged on " + trace.name);
+            }
+            result.peak_bytes = std::max(result.peak_bytes, bench::peakSince(baseline));
+        }
+        std::fprintf(stderr, ".");
+        return result;
+    }
+
+    template<std::size_t... I>
+    auto runAll(const Options &options, const std::vector<bench::EditTrace> &workload, std::index_sequence<I...>) -> std::vector<Result> {
+        return {run<candidates[I].first, candidates[I].second>(options, workload)...};
+    }
+
+    auto parse(int argc, char **argv) -> Options {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--edits" && has_value) options.edits = std::stoull(argv[++i]);
+            else if (arg == "--lookups" && has_value) options.lookups = std::stoull(argv[++i]);
+            else if (arg == "--scans" && has_value) options.scans = std::stoull(argv[++i]);
+            else if (arg == "--memory-weight" && has_value) options.memory_weight = std::stod(argv[++i]);
+            else options.traces.push_back(arg);
+        }
+        if (options.traces.empty()) options.traces = {"typing", "paste", "replace"};
+        return options;
+    }
+
+    auto preset(std::size_t leaf, std::size_t root) -> const char* {
+        auto is = [&]<typename P>(P) { return P::leaf_size == leaf && P::root_size == root; };
+        if (is(Rope::SmallChunks{})) return "Rope::SmallChunks";
+        if (is(Rope::MediumChunks{})) return "Rope::MediumChunks";
+        if (is(Rope::LargeChunks{})) return "Rope::LargeChunks";
+        return nullptr;
+    }
+}
+
+int main(int argc, char **argv) {
+    try {
+        auto options = parse(argc, argv);
+        std::vector<bench::EditTrace> workload;
+        for (auto &name : options.traces) {
+            bool synthetic = name == "typing" || name == "paste" || name == "replace";
+            auto trace = synthetic ? bench::generate(name, options.edits) : bench::load(name);
+            trace.end = bench::expectedEnd(trace);
+            workload.push_back(std::move(trace));
+        }
+
+        auto results = runAll(options, workload, std::make_index_sequence<candidates.size()>());
+        std::fprintf(stderr, "\n");
+        auto best_time = std::min_element(results.begin(), results.end(), [](auto &a, auto &b) { return a.milliseconds < b.milliseconds; })->milliseconds;
+        auto best_peak = std::min_element(results.begin(), results.end(), [](auto &a, auto &b) { return a.peak_bytes < b.peak_bytes; })->peak_bytes;
+        for (auto &r : results)
+            r.score = r.milliseconds / std::max(best_time, 1e-9) + options.memory_weight * static_cast<double>(r.peak_bytes) / static_cast<double>(std::max<std::size_t>(best_peak, 1));
+        std::sort(results.begin(), results.end(), [](auto &a, auto &b) { return a.score < b.score; });
+
+        std::printf("%8s %8s %12s %12s %8s\n", "leaf", "root", "time ms", "peak KB", "score");
+        for (auto &r : results)
+            std::printf("%8zu %8zu %12.1f %12zu %8.3f\n", r.leaf_size, r.root_size, r.milliseconds, r.peak_bytes >> 10, r.score);
+        auto &best = results.front();
+        std::printf("\nrecommended: Rope::ChunkPolicy<%zu, %zu>", best.leaf_size, best.root_size);
+        if (auto name = preset(best.leaf_size, best.root_size)) std::printf(" (%s)", name);
+        std::printf("\n  or globally: -DROPE_STRING_MAX_LEAF_SIZE=%zu -DROPE_STRING_MAX_ROOT_SIZE=%zu\n", best.leaf_size, best.root_size);
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "rope_autotune: %s\n", e.what());
+        return 1;
+    }
+}
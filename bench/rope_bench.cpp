@@ -0,0 +1,230 @@
+/*
+ * Microbenchmarks of Rope::String against std::string.
+ *
+ *   rope_bench_<leaf>_<root> [--min-size 1K] [--max-size 16M] [--budget-ms 200] [--filter insert]
+ *
+ * Every case runs on both strings at sizes from --min-size to --max-size (x32 steps, up to 1G)
+ * and prints ns/op and the peak heap growth while it ran. A case repeats its operation until
+ * the time budget is spent, so the slow side of a comparison still finishes.
+ */
+#include "bench.h"
+#include <RopeString.h>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr std::size_t unbounded = std::numeric_limits<std::size_t>::max();
+
+    struct Options {
+        std::size_t min_size = std::size_t(1) << 10;
+        std::size_t max_size = std::size_t(16) << 20;
+        std::chrono::milliseconds budget {200};
+        std::string filter;
+    };
+
+    struct Result {
+        double ns_per_op = 0;
+        std::size_t peak_bytes = 0;
+        std::size_t ops = 0;
+    };
+
+    /*
+     * setup() builds the state outside of the timed region, op(i) runs one operation.
+     * The peak covers setup as well, so it includes the string itself.
+     */
+    template<typename State, typename Setup, typename Op>
+    auto measure(const Options &options, std::size_t max_ops, Setup setup, Op op) -> Result {
+        auto baseline = bench::resetPeak();
+        Result result;
+        {
+            State state = setup();
+            auto start = bench::Clock::now();
+            auto deadline = start + options.budget;
+            std::size_t i = 0;
+            do {
+                op(state, i);
+            } while (++i < max_ops && bench::Clock::now() < deadline);
+            result.ns_per_op = bench::nanoseconds(bench::Clock::now() - start) / static_cast<double>(i);
+            result.ops = i;
+        }
+        result.peak_bytes = bench::peakSince(baseline);
+        return result;
+    }
+
+    auto text(std::size_t size) -> std::string {
+        std::string result(size, '\0');
+        std::mt19937 rng(7);
+        for (auto &ch : result) ch = static_cast<char>('a' + rng() % 26);
+        return result;
+    }
+
+    template<typename S>
+    auto make(const std::string &source) -> S {
+        if constexpr (std::is_same_v<S, Rope::String>) return Rope::String::from_buffer(std::span<const char>(source));
+        else return S(source);
+    }
+
+    // Random positions drawn once, op(i) reduces them modulo the current size
+    const std::vector<std::size_t> &positions() {
+        static const std::vector<std::size_t> drawn = [] {
+            std::vector<std::size_t> result(1 << 16);
+            std::mt19937_64 rng(42);
+            for (auto &p : result) p = rng();
+            return result;
+        }();
+        return drawn;
+    }
+    auto at(std::size_t i, std::size_t bound) -> std::size_t {
+        return bound ? positions()[i % positions().size()] % bound : 0;
+    }
+
+    struct Case {
+        const char *name;
+        // Runs the case on S at the given size
+        std::function<Result(const Options&, const std::string&)> rope, flat;
+    };
+
+    template<typename S>
+    auto insertCase(const Options &o, const std::string &source) -> Result {
+        return measure<S>(o, unbounded, [&] { return make<S>(source); }, [](S &s, std::size_t i) {
+            s.insert(at(i, s.size() + 1), "12345678");
+        });
+    }
+    template<typename S>
+    auto eraseCase(const Options &o, const std::string &source) -> Result {
+        return measure<S>(o, std::max<std::size_t>(1, source.size() / 16), [&] { return make<S>(source); }, [](S &s, std::size_t i) {
+            s.erase(at(i, s.size() - 8), 8);
+        });
+    }
+    template<typename S>
+    auto replaceCase(const Options &o, const std::string &source) -> Result {
+        return measure<S>(o, unbounded, [&] { return make<S>(source); }, [](S &s, std::size_t i) {
+            s.replace(at(i, s.size() - 8), 8, "abcdefgh");
+        });
+    }
+    // One op is one character visited. The string lives on the heap so the iterator survives moving the state
+    template<typename S>
+    auto iterateCase(const Options &o, const std::string &source) -> Result {
+        struct State {
+            std::unique_ptr<const S> s;
+            std::optional<typename S::const_iterator> it;
+            unsigned sum = 0;
+        };
+        return measure<State>(o, source.size(), [&] {
+            State state{std::make_unique<const S>(make<S>(source)), std::nullopt, 0};
+            state.it.emplace(state.s->cbegin());
+            return state;
+        }, [](State &state, std::size_t) {
+            state.sum += static_cast<unsigned char>(**state.it);
+            ++*state.it;
+            bench::keep(state.sum);
+        });
+    }
+    template<typename S>
+    auto indexCase(const Options &o, const std::string &source) -> Result {
+        return measure<const S>(o, unbounded, [&] { return make<S>(source); }, [](const S &s, std::size_t i) {
+            bench::keep(s[at(i, s.size())]);
+        });
+    }
+    template<typename S>
+    auto findCharCase(const Options &o, const std::string &source) -> Result {
+        return measure<const S>(o, unbounded, [&] { return make<S>(source); }, [](const S &s, std::size_t) {
+            bench::keep(s.find('#'));
+        });
+    }
+    template<typename S>
+    auto findStringCase(const Options &o, const std::string &source) -> Result {
+        return measure<const S>(o, unbounded, [&] { return make<S>(source); }, [](const S &s, std::size_t) {
+            bench::keep(s.find(std::string("needle#")));
+        });
+    }
+    template<typename S>
+    auto rfindStringCase(const Options &o, const std::string &source) -> Result {
+        return measure<const S>(o, unbounded, [&] { return make<S>(source); }, [](const S &s, std::size_t) {
+            bench::keep(s.rfind(std::string("needle#")));
+        });
+    }
+    template<typename S>
+    auto findFirstOfCase(const Options &o, const std::string &source) -> Result {
+        return measure<const S>(o, unbounded, [&] { return make<S>(source); }, [](const S &s, std::size_t) {
+            bench::keep(s.find_first_of(std::string("#@!")));
+        });
+    }
+    template<typename S>
+    auto substrCase(const Options &o, const std::string &source) -> Result {
+        return measure<const S>(o, unbounded, [&] { return make<S>(source); }, [](const S &s, std::size_t i) {
+            auto part = s.substr(at(i, s.size()), 64);
+            bench::keep(part.size());
+        });
+    }
+    template<typename S>
+    auto cStrCase(const Options &o, const std::string &source) -> Result {
+        return measure<const S>(o, unbounded, [&] { return make<S>(source); }, [](const S &s, std::size_t) {
+            auto str = s.c_str();
+            bench::keep(&str[0]);
+        });
+    }
+    template<typename S>
+    auto constructCase(const Options &o, const std::string &source) -> Result {
+        return measure<int>(o, unbounded, [] { return 0; }, [&](int, std::size_t) {
+            S s(source.data(), source.size());
+            bench::keep(s.size());
+        });
+    }
+
+#define ROPE_BENCH_CASE(name, fn) Case{name, fn<Rope::String>, fn<std::string>}
+    const std::vector<Case> cases {
+        ROPE_BENCH_CASE("insert", insertCase),
+        ROPE_BENCH_CASE("erase", eraseCase),
+        ROPE_BENCH_CASE("replace", replaceCase),
+        ROPE_BENCH_CASE("iterate", iterateCase),
+        ROPE_BENCH_CASE("operator[]", indexCase),
+        ROPE_BENCH_CASE("find(char)", findCharCase),
+        ROPE_BENCH_CASE("find(string)", findStringCase),
+        ROPE_BENCH_CASE("rfind(string)", rfindStringCase),
+        ROPE_BENCH_CASE("find_first_of", findFirstOfCase),
+        ROPE_BENCH_CASE("substr", substrCase),
+        ROPE_BENCH_CASE("c_str", cStrCase),
+        ROPE_BENCH_CASE("construct", constructCase),
+    };
+#undef ROPE_BENCH_CASE
+
+    auto parse(int argc, char **argv) -> Options {
+        Options options;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            std::string_view flag = argv[i], value = argv[i + 1];
+            if (flag == "--min-size") options.min_size = bench::parseSize(value);
+            else if (flag == "--max-size") options.max_size = bench::parseSize(value);
+            else if (flag == "--budget-ms") options.budget = std::chrono::milliseconds(std::stoll(std::string(value)));
+            else if (flag == "--filter") options.filter = value;
+        }
+        options.min_size = std::max<std::size_t>(options.min_size, 64);
+        return options;
+    }
+}
+
+int main(int argc, char **argv) {
+    auto options = parse(argc, argv);
+    std::printf("leaf %zu, root %zu\n", Rope::max_leaf_size, Rope::max_root_size);
+    std::printf("%-14s %6s %14s %14s %8s %12s %12s\n", "case", "size", "rope ns/op", "std ns/op", "ratio", "rope peak KB", "std peak KB");
+    for (auto size = options.min_size; size <= options.max_size; size *= 32) {
+        auto source = text(size);
+        for (auto &c : cases) {
+            if (!options.filter.empty() && std::string_view(c.name).find(options.filter) == std::string_view::npos) continue;
+            auto rope = c.rope(options, source);
+            auto flat = c.flat(options, source);
+            std::printf("%-14s %6s %14.1f %14.1f %8.2f %12zu %12zu\n", c.name, bench::formatSize(size).c_str(),
+                        rope.ns_per_op, flat.ns_per_op, rope.ns_per_op / flat.ns_per_op,
+                        rope.peak_bytes >> 10, flat.peak_bytes >> 10);
+            std::fflush(stdout);
+        }
+    }
+}
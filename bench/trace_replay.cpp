@@ -0,0 +1,102 @@
+/*
+ * Editing trace replay: applies a recorded sequence of edits to Rope::String, std::string and,
+ * where libstdc++ ships it, __gnu_cxx::crope, checks that all of them end with the same text
+ * and reports throughput and heap use over time.
+ *
+ *   trace_replay                                  replay the built-in synthetic traces
+ *   trace_replay replay <file>...                 replay recorded traces
+ *   trace_replay generate <kind> <file> [edits]   write a synthetic trace: typing, paste or replace
+ *
+ * The trace file format is described in edit_trace.h.
+ */
+#include "bench.h"
+#include "edit_trace.h"
+#include <RopeString.h>
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#if __has_include(<ext/rope>)
+#include <ext/rope>
+#define ROPE_BENCH_CROPE 1
+#endif
+
+namespace {
+    constexpr std::size_t default_edits = 50000;
+
+    struct Sample {
+        std::size_t edits;
+        double milliseconds;
+        std::size_t heap_bytes;
+    };
+
+    template<typename S>
+    auto contents(const S &s) -> std::string {
+        if constexpr (std::is_same_v<S, std::string>) return s;
+        else if constexpr (requires { s.stats(); }) {
+            std::string flat(s.size(), '\0');
+            s.copy(flat.data(), flat.size());
+            return flat;
+        } else return std::string(s.begin(), s.end());
+    }
+
+    template<typename S>
+    void replay(const char *name, const bench::EditTrace &trace, const std::string &expected) {
+        constexpr std::size_t samples = 8;
+        auto baseline = bench::resetPeak();
+        std::vector<Sample> timeline;
+        std::string result;
+        double total_ms;
+        {
+            S s(trace.start.data(), trace.start.size());
+            auto every = std::max<std::size_t>(1, trace.edits.size() / samples);
+            auto start = bench::Clock::now();
+            for (std::size_t i = 0; i < trace.edits.size(); ++i) {
+                bench::apply(s, trace.edits[i]);
+                if ((i + 1) % every == 0 || i + 1 == trace.edits.size())
+                    timeline.push_back({i + 1, bench::nanoseconds(bench::Clock::now() - start) / 1e6,
+                                        bench::live_bytes.load(std::memory_order_relaxed) - baseline});
+            }
+            total_ms = bench::nanoseconds(bench::Clock::now() - start) / 1e6;
+            result = contents(s);
+        }
+        auto peak = bench::peakSince(baseline);
+        auto edits_per_second = trace.edits.empty() ? 0.0 : static_cast<double>(trace.edits.size()) / (total_ms / 1e3);
+        std::printf("  %-12s %10.1f ms %14.0f edits/s %10zu KB peak  %s\n", name, total_ms, edits_per_second,
+                    peak >> 10, result == expected ? "ok" : "CONTENT MISMATCH");
+        std::printf("  %-12s", "");
+        for (auto &sample : timeline) std::printf(" %zu:%.0fms/%zuKB", sample.edits, sample.milliseconds, sample.heap_bytes >> 10);
+        std::printf("\n");
+        if (result != expected) throw std::runtime_error(std::string(name) + " diverged on " + trace.name);
+    }
+
+    void replayAll(const bench::EditTrace &trace) {
+        auto expected = bench::expectedEnd(trace);
+        std::printf("%s: %zu edits, %zu -> %zu characters\n", trace.name.c_str(), trace.edits.size(), trace.start.size(), expected.size());
+        replay<Rope::String>("Rope::String", trace, expected);
+        replay<std::string>("std::string", trace, expected);
+#ifdef ROPE_BENCH_CROPE
+        replay<__gnu_cxx::crope>("crope", trace, expected);
+#endif
+    }
+}
+
+int main(int argc, char **argv) {
+    try {
+        std::vector<std::string> args(argv + 1, argv + argc);
+        if (args.empty()) {
+            for (auto kind : {"typing", "paste", "replace"}) replayAll(bench::generate(kind, default_edits));
+        } else if (args[0] == "generate" && args.size() >= 3) {
+            bench::save(bench::generate(args[1], args.size() > 3 ? std::stoull(args[3]) : default_edits), args[2]);
+        } else if (args[0] == "replay" && args.size() >= 2) {
+            for (std::size_t i = 1; i < args.size(); ++i) replayAll(bench::load(args[i]));
+        } else {
+            std::fprintf(stderr, "usage: trace_replay [replay <file>... | generate <typing|paste|replace> <file> [edits]]\n");
+            return 2;
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "trace_replay: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef ROPE_ANCHOR_H
+#define ROPE_ANCHOR_H
+
+#include <cstddef>
+#include <memory>
+
+namespace Rope {
+    /*
+     * Which side of an insertion made exactly at the anchor the anchor ends up on.
+     * Left keeps the anchor before the inserted text, Right moves it after.
+     */
+    enum class Gravity { Left, Right };
+
+    /*
+     * Position record shared by an Anchor and the bucket of the root it lives in.
+     * The offset is local to that root, so edits in other roots never touch it.
+     */
+    struct Mark {
+        std::size_t root = 0;
+        std::size_t offset = 0;
+        Gravity gravity = Gravity::Right;
+    };
+
+    /*
+     * Handle to a position inside a Tree that follows every edit of that tree.
+     * Once the handle and its copies are dropped, the tree forgets the mark the next time an edit passes it.
+     */
+    class Anchor {
+        std::shared_ptr<Mark> mark;
+    public:
+        Anchor() = default;
+        explicit Anchor(std::shared_ptr<Mark> mark) : mark(std::move(mark)) {}
+
+        auto gravity() const -> Gravity { return mark->gravity; }
+        auto valid() const -> bool { return static_cast<bool>(mark); }
+        auto get() const -> const Mark& { return *mark; }
+    };
+}
+#endif //ROPE_ANCHOR_H
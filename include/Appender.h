@@ -0,0 +1,185 @@
+#ifndef ROPE_APPENDER_H
+#define ROPE_APPENDER_H
+#include <BasicString.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace Rope {
+    /*
+     * PerProducer: text of one producer keeps its order, batches of different producers interleave.
+     * Sequenced: every append() takes a global ticket and the string follows ticket order.
+     */
+    enum class AppendOrder { PerProducer, Sequenced };
+
+    /*
+     * Many threads appending to one string. Each producer fills its own buffer, a full buffer is
+     * sealed into roots outside of any shared lock and the roots are spliced onto the string,
+     * so the shared lock only covers moving root pointers.
+     *
+     * The string must not be touched directly while producers are running,
+     * flush() once they are done makes everything appended so far part of it.
+     */
+    template<typename CharT, typename Traits = std::char_traits<CharT>, typename Allocator = std::allocator<CharT>, SizePolicy Policy = DefaultChunks>
+    class BasicAppender {
+        using StringType = BasicString<CharT, Traits, Allocator, Policy>;
+        using BufferType = std::basic_string<CharT, Traits, Allocator>;
+
+        // Sequenced only: ticket of one append() and where its text ends in the batch
+        struct Item {
+            std::uint64_t sequence;
+            std::size_t end;
+        };
+        struct Batch {
+            BufferType text;
+            std::vector<Item> items;
+        };
+        struct Buffer {
+            std::mutex mutex; // uncontended unless flush() runs
+            Batch batch;
+            bool taken = false;
+            // the text allocates like the target, so sealing it can hand the buffer over
+            explicit Buffer(const Allocator &allocator) : batch{BufferType(allocator), {}} {}
+        };
+
+        StringType &target;
+        AppendOrder order;
+        std::size_t batch_size;
+        std::atomic<std::uint64_t> sequence {0};
+        std::deque<Buffer> buffers;
+        std::mutex buffers_mutex;  // producer registration
+        std::mutex flush_mutex;    // one flush() at a time
+        std::mutex splice_mutex;   // target and pending
+        std::vector<Batch> pending; // Sequenced: sealed batches waiting for flush()
+
+        // Move the batch out and leave it empty. Assigning a new one instead would not carry the allocator over
+        static auto take(Batch &batch) -> Batch {
+            auto taken = std::move(batch);
+            batch.text.clear();
+            batch.items.clear();
+            return taken;
+        }
+        // Caller holds buffer.mutex
+        void seal(Buffer &buffer) {
+            if (buffer.batch.text.empty()) return;
+            auto batch = take(buffer.batch);
+            if (order == AppendOrder::Sequenced) {
+                std::lock_guard lock(splice_mutex);
+                pending.push_back(std::move(batch));
+                return;
+            }
+            // the buffer becomes the part's leaf as it is, see BasicString::append(StringType&&)
+            StringType part(target.get_allocator());
+            part.append(std::move(batch.text));
+            std::lock_guard lock(splice_mutex);
+            target.append(std::move(part));
+        }
+
+    public:
+        // Per-thread appending handle
+        class Producer {
+            BasicAppender *owner;
+            Buffer *buffer;
+        public:
+            explicit Producer(BasicAppender &appender) : owner(&appender) {
+                std::lock_guard lock(owner->buffers_mutex);
+                auto free = std::find_if(owner->buffers.begin(), owner->buffers.end(), [](Buffer &b) { return !b.taken; });
+                buffer = free != owner->buffers.end() ? &*free : &owner->buffers.emplace_back(owner->target.get_allocator());
+                buffer->taken = true;
+            }
+            Producer(const Producer&) = delete;
+            auto operator=(const Producer&) -> Producer& = delete;
+            ~Producer() {
+                flush();
+                std::lock_guard lock(owner->buffers_mutex);
+                buffer->taken = false;
+            }
+
+            void append(std::basic_string_view<CharT, Traits> text) {
+                std::lock_guard lock(buffer->mutex);
+                auto &batch = buffer->batch;
+                batch.text.append(text);
+                if (owner->order == AppendOrder::Sequenced)
+                    batch.items.push_back({owner->sequence.fetch_add(1, std::memory_order_relaxed), batch.text.size()});
+                if (batch.text.size() >= owner->batch_size) owner->seal(*buffer);
+            }
+            void push_back(CharT ch) {
+                append(std::basic_string_view<CharT, Traits>(&ch, 1));
+            }
+            // Seal what this producer buffered, PerProducer splices it right away
+            void flush() {
+                std::lock_guard lock(buffer->mutex);
+                owner->seal(*buffer);
+            }
+        };
+
+        /*
+         * batch_size: characters a producer buffers before sealing them,
+         * larger batches mean fewer splices and fuller roots.
+         */
+        explicit BasicAppender(StringType &target, AppendOrder order = AppendOrder::PerProducer,
+                               std::size_t batch_size = 64 * Policy::root_size)
+            : target(target), order(order), batch_size(std::max<std::size_t>(1, batch_size)) {}
+        BasicAppender(const BasicAppender&) = delete;
+        auto operator=(const BasicAppender&) -> BasicAppender& = delete;
+        // Producers must be gone by now
+        ~BasicAppender() { flush(); }
+
+        auto producer() -> Producer { return Producer(*this); }
+
+        /*
+         * Move every append() that returned before this call into the string.
+         * Sequenced merges the sealed batches by ticket; tickets taken later are all larger,
+         * since the buffers are collected while every producer is held.
+         */
+        void flush() {
+            std::lock_guard serial(flush_mutex);
+            std::vector<Batch> collected;
+            {
+                std::lock_guard registry(buffers_mutex);
+                std::vector<std::unique_lock<std::mutex>> held;
+                for (auto &buffer : buffers) held.emplace_back(buffer.mutex);
+                if (order == AppendOrder::PerProducer) {
+                    for (auto &buffer : buffers) seal(buffer);
+                    return;
+                }
+                std::lock_guard lock(splice_mutex);
+                collected = std::move(pending);
+                pending.clear();
+                for (auto &buffer : buffers)
+                    if (!buffer.batch.text.empty()) collected.push_back(take(buffer.batch));
+            }
+            if (collected.empty()) return;
+
+            struct Piece {
+                std::uint64_t sequence;
+                const CharT *data;
+                std::size_t size;
+            };
+            std::vector<Piece> pieces;
+            std::size_t total = 0;
+            for (auto &batch : collected) {
+                std::size_t begin = 0;
+                for (auto &item : batch.items) {
+                    pieces.push_back({item.sequence, batch.text.data() + begin, item.end - begin});
+                    begin = item.end;
+                }
+                total += batch.text.size();
+            }
+            std::sort(pieces.begin(), pieces.end(), [](const Piece &a, const Piece &b) { return a.sequence < b.sequence; });
+            BufferType merged(target.get_allocator());
+            merged.reserve(total);
+            for (auto &piece : pieces) merged.append(piece.data, piece.size);
+
+            StringType part(target.get_allocator());
+            part.append(std::move(merged));
+            std::lock_guard lock(splice_mutex);
+            target.append(std::move(part));
+        }
+    };
+}
+#endif //ROPE_APPENDER_H
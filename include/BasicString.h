@@ -7,14 +7,35 @@
 #include <functional>
 #include <ranges>
 #include <cstring>
+#include <span>
+#include <atomic>
+#include <array>
+#include <variant>
+#include <utility>
+#include <Parallel.h>
+#include <Serialize.h>
+#include <Trace.h>
 
 namespace Rope {
-    template<typename CharT, typename Traits = std::char_traits<CharT>, typename Allocator = std::allocator<CharT>>
+    template<typename CharT, typename Traits, typename Allocator, SizePolicy Policy>
+    class BasicStringView;
+    template<typename CharT, typename Traits, typename Allocator, SizePolicy Policy>
+    class BasicSplitView;
+
+    template<typename CharT, typename Traits = std::char_traits<CharT>, typename Allocator = std::allocator<CharT>, SizePolicy Policy = DefaultChunks>
     class BasicString {
         using StringType = std::basic_string<CharT, Traits, Allocator>;
         using NodeType = Node<CharT, Traits, Allocator>;
-        using TreeType = Tree<CharT, Traits, Allocator>;
+        using TreeType = Tree<CharT, Traits, Allocator, Policy>;
+        using AllocTraits = std::allocator_traits<Allocator>;
+        // Moves never copy characters unless the allocator stays behind and may differ, as with std::pmr
+        static constexpr bool nothrow_move_assign = AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value;
     public:
+        using policy_type = Policy;
+        static constexpr std::size_t max_leaf_size = Policy::leaf_size;
+        static constexpr std::size_t max_root_size = Policy::root_size;
+        // Strings of at most small_size characters live inside the object and allocate nothing
+        static constexpr std::size_t small_size = Policy::small_size;
         using traits_type = Traits;
         using value_type = CharT;
         using allocator_type = Allocator;
@@ -26,7 +47,8 @@ namespace Rope {
         using const_pointer = const std::allocator_traits<Allocator>::pointer;
         template<typename CharType>
         class iterator {
-            using TreeType = Tree<CharType, Traits, Allocator>;
+            // iterators only read: the leaves of the tree, or the inline text of a small string
+            using TreeType = const Tree<CharT, Traits, Allocator, Policy>;
         public:
             using value_type        = CharType;
             using difference_type   = std::ptrdiff_t;
@@ -34,33 +56,37 @@ namespace Rope {
             using reference         = CharType&;
             using iterator_category = std::forward_iterator_tag;
 
-            explicit iterator(TreeType &tree, std::size_t pos) : tree_(tree) {
-                auto size = tree_.size();
+            explicit iterator(TreeType &tree, std::size_t pos) : tree_(&tree) {
+                auto size = tree_->size();
                 if (pos >= size) {
                     current = nullptr;
                     global_pos = size;
                     return;
                 }
-                std::size_t offset = 0;
                 global_pos = pos;
-                current = tree.getLeafByIndex(pos, offset);
-                this->pos = offset;
+                seek(pos);
             }
-            explicit iterator(TreeType &tree) : tree_(tree) {}
+            explicit iterator(TreeType &tree) : tree_(&tree) {}
+            // Over the inline text of a small string, which stays valid until the string changes like a std::basic_string buffer
+            explicit iterator(const CharT *text, std::size_t size, std::size_t pos) : text_(text), size_(size), global_pos(std::min(pos, size)) {}
             auto operator*() const -> CharT {
+                if (text_) return text_[global_pos];
                 return current->str[pos];
             }
 
             auto operator++() -> iterator& {
-                auto size = tree_.size();
+                auto size = text_ ? size_ : tree_->size();
                 if (global_pos + 1 >= size) {
                     global_pos = size;
                     current = nullptr;
                     return *this;
                 }
                 global_pos++;
+                if (text_) return *this;
                 if (pos + 1 >= current->str.size()) {
-                    current = tree_.nextLeaf(current);
+                    // roots emptied by erase keep an empty node, step over it
+                    do nextLeaf();
+                    while (current && current->str.empty());
                     pos = 0;
                 } else {
                     ++pos;
@@ -85,15 +111,37 @@ namespace Rope {
             auto position() const -> std::size_t { return global_pos; }
 
         protected:
-            TreeType &tree_;
-            std::size_t pos;
-            std::size_t global_pos;
+            TreeType *tree_ = nullptr;
+            const CharT *text_ = nullptr;
+            std::size_t size_ = 0;
+            std::size_t pos = 0;
+            std::size_t global_pos = 0;
+            std::size_t root = 0;
             NodeType *current = nullptr;
+
+            // Leaves are tracked with their root index: copies share root nodes, so a node does not identify its root
+            void seek(std::size_t index) {
+                auto &roots = tree_->getRoots();
+                root = 0;
+                while (index >= roots[root].second) index -= roots[root++].second;
+                current = roots[root].first->getLeafByIndex(index);
+                pos = index;
+            }
+            void nextLeaf() {
+                auto &roots = tree_->getRoots();
+                if (current->right) current = current->right.get();
+                else current = ++root < roots.size() ? roots[root].first.get() : nullptr;
+            }
+            void prevLeaf() {
+                auto &roots = tree_->getRoots();
+                if (current->top) current = current->top;
+                else current = root-- > 0 ? roots[root].first->rightmostLeaf() : nullptr;
+            }
         };
         template<typename CharType>
         class reverse_iterator : public iterator<CharType> {
             using Base = iterator<CharType>;
-            using TreeType = Tree<CharType, Traits, Allocator>;
+            using TreeType = const Tree<CharT, Traits, Allocator, Policy>;
         public:
             explicit reverse_iterator(TreeType &tree, std::size_t pos = 0) : Base(tree) {
                 auto size = tree.size();
@@ -102,10 +150,11 @@ namespace Rope {
                     Base::global_pos = std::size_t(-1);
                     return;
                 }
-                std::size_t offset = 0;
                 Base::global_pos = size - pos - 1;
-                Base::current = tree.getLeafByIndex(Base::global_pos, offset);
-                Base::pos = Base::current->str.size() - offset;
+                Base::seek(Base::global_pos);
+            }
+            explicit reverse_iterator(const CharT *text, std::size_t size, std::size_t pos = 0) : Base(text, size, 0) {
+                Base::global_pos = size - std::min(pos, size) - 1;
             }
             auto operator++() -> reverse_iterator& {
                 if (Base::global_pos - 1 == std::size_t(-1)) {
@@ -114,8 +163,10 @@ namespace Rope {
                     return *this;
                 }
                 Base::global_pos--;
+                if (Base::text_) return *this;
                 if (Base::pos - 1 == std::size_t(-1)) {
-                    Base::current = Base::tree_.prevLeaf(Base::current);
+                    do Base::prevLeaf();
+                    while (Base::current && Base::current->str.empty());
                     Base::pos = Base::current->str.size() - 1;
                 } else {
                     --Base::pos;
@@ -129,63 +180,117 @@ namespace Rope {
                 return tmp;
             }
         };
+        using Edit = typename TreeType::Edit;
         using const_iterator = iterator<const CharT>;
         using reverse_const_iterator = reverse_iterator<const CharT>;
         static constexpr auto npos = StringType::npos;
         BasicString() {}
-        BasicString(const Allocator &alloc) : tree(alloc) {}
-        BasicString(size_type count, CharT ch, const Allocator& alloc = Allocator()) {
-            tree.push(StringType(count, ch, alloc));
+        BasicString(const Allocator &alloc) : allocator(alloc) {}
+        BasicString(size_type count, CharT ch, const Allocator& alloc = Allocator()) : allocator(alloc) {
+            append(count, ch);
         }
         template<typename InputIt>
-        BasicString(const InputIt first, InputIt last, Allocator alloc = Allocator()) {
-            tree.push(StringType(first, last, alloc));
+        BasicString(const InputIt first, InputIt last, Allocator alloc = Allocator()) : allocator(alloc) {
+            pushRange(first, last);
         }
 #ifdef __cpp_lib_from_range
         template<std::ranges::range R>
         requires std::convertible_to<std::ranges::range_value_t<R>, CharT>
-        BasicString(std::from_range_t, R&& rg, const Allocator& alloc = Allocator()) : tree(alloc) {
-            for (auto&& c : rg) {
-                tree.push(StringType(1, c, alloc));
-            }
+        BasicString(std::from_range_t, R&& rg, const Allocator& alloc = Allocator()) : allocator(alloc) {
+            pushRange(std::ranges::begin(rg), std::ranges::end(rg));
         }
 #endif
-        BasicString( const CharT* s, size_type count, const Allocator& alloc = Allocator() ) {
-            tree.push(StringType(s, count, alloc));
+        BasicString( const CharT* s, size_type count, const Allocator& alloc = Allocator() ) : allocator(alloc) {
+            pushText({s, count});
         }
-        BasicString( const CharT* s, const Allocator& alloc = Allocator() ) {
-            tree.push(StringType(s, alloc));
+        BasicString( const CharT* s, const Allocator& alloc = Allocator() ) : allocator(alloc) {
+            pushText(s);
         }
         BasicString(std::nullptr_t) = delete;
         template<typename StringViewLike>
-        explicit BasicString( const StringViewLike& t, const Allocator& alloc = Allocator() ) {
-            tree.push(StringType(t, alloc));
+        requires (!std::is_convertible_v<const StringViewLike&, Allocator>) // a memory_resource* is an allocator, not text
+        explicit BasicString( const StringViewLike& t, const Allocator& alloc = Allocator() ) : allocator(alloc) {
+            pushView(t);
         }
         template<typename StringViewLike>
-        BasicString(const StringViewLike& t, size_type pos, size_type count, const Allocator& alloc = Allocator() ) {
-            tree.push(StringType(t, pos, count, alloc));
+        requires std::is_convertible_v<const StringViewLike&, std::basic_string_view<CharT, Traits>>
+        BasicString(const StringViewLike& t, size_type pos, size_type count, const Allocator& alloc = Allocator() ) : allocator(alloc) {
+            pushText(std::basic_string_view<CharT, Traits>(t).substr(pos, count));
+        }
+
+        // Take over the buffer of `str` as a leaf instead of copying it, see Tree::adopt
+        explicit BasicString(StringType &&str) : allocator(str.get_allocator()) {
+            pushOwned(std::move(str));
         }
 
-        BasicString( const BasicString& other ) {
-            tree = other.tree;
+        BasicString( const BasicString& other ) : allocator(AllocTraits::select_on_container_copy_construction(other.allocator)) {
+            assignFrom(other);
         }
-        BasicString(BasicString &&other) noexcept {
-            tree = std::move(other.tree);
+        BasicString(BasicString &&other) noexcept : allocator(other.allocator) {
+            assignFrom(std::move(other));
         }
-        BasicString( const BasicString& other, const Allocator &alloc) : tree(alloc){
-            tree = other.tree;
+        BasicString( const BasicString& other, const Allocator &alloc) : allocator(alloc) {
+            assignFrom(other);
         }
-        BasicString(BasicString &&other, const Allocator &alloc) : tree(alloc) {
-            tree = std::move(other.tree);
+        BasicString(BasicString &&other, const Allocator &alloc) : allocator(alloc) {
+            if (alloc == other.allocator) assignFrom(std::move(other));
+            else assignFrom(std::as_const(other));
         }
-        BasicString( const BasicString& other, size_type pos, const Allocator& alloc = Allocator() ) : tree(alloc) {
-            tree.push(StringType(other, pos, alloc));
+        BasicString( const BasicString& other, size_type pos, const Allocator& alloc = Allocator() ) : allocator(alloc) {
+            assignFrom(other.substr(pos));
         };
-        BasicString( const BasicString& other, size_type pos, size_type count, const Allocator& alloc = Allocator() ) : tree(alloc) {
-            tree.push(StringType(other, pos, count, alloc));
+        BasicString( const BasicString& other, size_type pos, size_type count, const Allocator& alloc = Allocator() ) : allocator(alloc) {
+            assignFrom(other.substr(pos, count));
         };
-        BasicString(std::initializer_list<CharT> ilist, const Allocator& alloc = Allocator() ) : tree(alloc) {
-            tree.push(StringType(ilist, alloc));
+        BasicString(std::initializer_list<CharT> ilist, const Allocator& alloc = Allocator() ) : allocator(alloc) {
+            pushText({ilist.begin(), ilist.size()});
+        }
+        // Build from a large buffer in one pass, see Tree::build. A text of at most small_size characters stays inline
+        static auto from_buffer(std::span<const CharT> text, const Allocator& alloc = Allocator()) -> BasicString {
+            BasicString result(alloc);
+            if (text.size() <= small_size) result.pushText({text.data(), text.size()});
+            else result.storage.template emplace<TreeType>(TreeType::build(text, alloc));
+            return result;
+        }
+        template<ParallelContext Context>
+        static auto from_buffer(Context &&context, std::span<const CharT> text, const Allocator& alloc = Allocator()) -> BasicString {
+            BasicString result(alloc);
+            if (text.size() <= small_size) result.pushText({text.data(), text.size()});
+            else result.storage.template emplace<TreeType>(TreeType::build(std::forward<Context>(context), text, alloc));
+            return result;
+        }
+
+        /*
+         * Binary save and load keeping the chunk layout, see Serialize.h for the format. Both directions
+         * stream leaf by leaf. A mapped image is read in place, one copy per leaf, on several threads
+         * with a policy or executor.
+         */
+        auto serialize(std::ostream &out, SerializeOptions options = {}) const -> void {
+            writeSerial(tree(), serialWriter(out), options);
+        }
+        static auto deserialize(std::istream &in, const Allocator& alloc = Allocator()) -> BasicString {
+            return readSerial(serialReader(in), alloc);
+        }
+#ifdef ROPE_SERIAL_FD
+        auto serialize(int fd, SerializeOptions options = {}) const -> void {
+            writeSerial(tree(), serialWriter(fd), options);
+        }
+        static auto deserialize(int fd, const Allocator& alloc = Allocator()) -> BasicString {
+            return readSerial(serialReader(fd), alloc);
+        }
+#endif
+        static auto deserialize(std::span<const std::byte> image, const Allocator& alloc = Allocator()) -> BasicString {
+            auto [layout, payload] = mapSerial(image);
+            return fromTree(TreeType::assemble(layout.root_leaves, [&](std::size_t leaf) {
+                return imageLeaf(layout, payload, leaf, alloc);
+            }, alloc));
+        }
+        template<ParallelContext Context>
+        static auto deserialize(Context &&context, std::span<const std::byte> image, const Allocator& alloc = Allocator()) -> BasicString {
+            auto [layout, payload] = mapSerial(image);
+            return fromTree(TreeType::assemble(std::forward<Context>(context), layout.root_leaves, [&](std::size_t leaf) {
+                return imageLeaf(layout, payload, leaf, alloc);
+            }, alloc));
         }
 
         void print() {
@@ -194,99 +299,95 @@ namespace Rope {
 
         // (1) assign from const basic_string&
         auto assign(const BasicString& str) -> BasicString& {
-            tree.clear();
-            for (auto& root : str.tree.roots) {
-                tree.push(root->str); // copy each root string
-            }
+            assignFrom(str);
             return *this;
         }
 
         // (2) assign from rvalue basic_string
-        auto assign(BasicString&& str) noexcept -> BasicString& {
-            tree = std::move(str.tree);
+        auto assign(BasicString&& str) noexcept(nothrow_move_assign) -> BasicString& {
+            assignFrom(std::move(str));
+            return *this;
+        }
+        // (2b) assign from an rvalue std::basic_string, adopting its buffer
+        auto assign(StringType&& str) -> BasicString& {
+            clear();
+            pushOwned(std::move(str));
             return *this;
         }
 
         // (3) assign count copies of a char
         auto assign(size_type count, CharT ch) -> BasicString& {
-            tree.clear();
-            tree.push(StringType(count, ch));
+            clear();
+            append(count, ch);
             return *this;
         }
 
         // (4) assign from const CharT* with count
         auto assign(const CharT* s, size_type count) -> BasicString& {
-            tree.clear();
-            tree.push(StringType(s, count));
+            assignText({s, count});
             return *this;
         }
 
         // (5) assign from const CharT* null-terminated
         auto assign(const CharT* s) -> BasicString& {
-            tree.clear();
-            tree.push(StringType(s));
+            assignText(s);
             return *this;
         }
 
         // (6) assign from StringViewLike
         template<typename SV>
         auto assign(const SV& t) -> BasicString& {
-            tree.clear();
-            tree.push(StringType(t));
+            assignView(t);
             return *this;
         }
 
         // (7) assign from StringViewLike with pos/count
         template<typename SV>
+        requires std::is_convertible_v<const SV&, std::basic_string_view<CharT, Traits>> && (!std::is_convertible_v<const SV&, const CharT*>)
         auto assign(const SV& t, size_type pos, size_type count = StringType::npos) -> BasicString& {
-            tree.clear();
-            tree.push(StringType(t, pos, count));
+            assignText(std::basic_string_view<CharT, Traits>(t).substr(pos, count));
             return *this;
         }
 
         // (8) assign from basic_string with pos/count
         auto assign(const BasicString& str, size_type pos, size_type count = StringType::npos) -> BasicString& {
-            tree.clear();
-            StringType tmp = str.tree.substr(pos, count);
-            tree.push(tmp);
+            assignFrom(str.substr(pos, count));
             return *this;
         }
 
         // (9) assign from input iterators
         template<typename InputIt>
         auto assign(InputIt first, InputIt last) -> BasicString& {
-            tree.clear();
-            tree.push(StringType(first, last));
+            clear();
+            pushRange(first, last);
             return *this;
         }
 
         // (10) assign from initializer_list
         auto assign(std::initializer_list<CharT> ilist) -> BasicString& {
-            tree.clear();
-            tree.push(StringType(ilist.begin(), ilist.end()));
+            assignText({ilist.begin(), ilist.size()});
             return *this;
         }
 #ifdef __cpp_lib_from_range
         template<std::ranges::range R>
         requires std::convertible_to<std::ranges::range_value_t<R>, CharT>
         auto assign_range(R&& rg) -> BasicString& {
-            for (auto&& c : rg) {
-                tree.push(StringType(1, c, tree.get_allocator()));
-            }
+            clear();
+            pushRange(std::ranges::begin(rg), std::ranges::end(rg));
             return *this;
         }
 #endif
         auto get_allocator() const -> allocator_type {
-            return tree.get_allocator();
+            return allocator;
         }
         auto at(size_type pos) -> CharT {
-            if (pos >= tree.size()) {
+            if (pos >= size()) {
                 throw std::out_of_range("Rope::BasicString::at");
             }
             return getAtPos(pos);
         }
         auto at(size_type pos) const -> const CharT {
-            if (pos >= tree.size()) {
+            if (pos >= size()) {
                 throw std::out_of_range("Rope::BasicString::at");
             }
             return getAtPos(pos);
@@ -298,15 +399,17 @@ namespace Rope {
             return getAtPos(pos);
         }
         auto front() -> CharT& {
-            for (auto &r : tree.getRoots()) {
-                NodeType* leaf = r.first.get();
-                while (leaf->left) leaf = leaf->left.get();
-                if (!leaf->str.empty()) return leaf->str.front();
-            }
-            throw std::out_of_range("rope is empty");
+            if (empty()) throw std::out_of_range("rope is empty");
+            // a write through the reference changes the inline text only, tree() notices it and builds a new image
+            if (auto text = small()) return text->data[0];
+            return rope().charAt(0);
         }
         auto front() const -> const CharT& {
-            for (auto &r : tree.getRoots()) {
+            if (auto text = small()) {
+                if (text->size) return text->data[0];
+                throw std::out_of_range("rope is empty");
+            }
+            for (auto &r : tree().getRoots()) {
                 NodeType* leaf = r.first.get();
                 while (leaf->left) leaf = leaf->left.get();
                 if (!leaf->str.empty()) return leaf->str.front();
@@ -314,38 +417,105 @@ namespace Rope {
             throw std::out_of_range("rope is empty");
         }
         auto back() -> CharT& {
-            for (auto it = tree.getRoots().rbegin(); it != tree.getRoots().rend(); ++it) {
-                NodeType* leaf = it->first.get();
-                while (leaf->right) leaf = leaf->right.get();
-                if (!leaf->str.empty()) return leaf->str.back();
+            if (auto text = small()) {
+                if (!text->size) throw std::out_of_range("Rope::Tree::back");
+                return text->data[text->size - 1];
             }
-            throw std::out_of_range("rope is empty");
+            return rope().back();
         }
         auto back() const -> const CharT& {
-            for (auto it = tree.getRoots().rbegin(); it != tree.getRoots().rend(); ++it) {
-                NodeType* leaf = it->first.get();
-                while (leaf->right) leaf = leaf->right.get();
-                if (!leaf->str.empty()) return leaf->str.back();
+            if (auto text = small()) {
+                if (!text->size) throw std::out_of_range("Rope::Tree::back");
+                return text->data[text->size - 1];
             }
-            throw std::out_of_range("rope is empty");
+            return tree().back();
         }
 
         /*
-         * Return raw tree reference
+         * Return raw tree reference. A small string answers with a tree built from its inline text,
+         * valid until the next mutation.
          */
         auto data() const -> const TreeType& {
-            return tree;
+            return tree();
+        }
+        /*
+         * Contiguous view of the whole text, valid until the next mutation. A small string or a text held in a
+         * single leaf is viewed in place, otherwise a flat copy is made on the first call and reused until the rope changes.
+         * Safe to call from concurrent readers of an unchanging string.
+         */
+        auto view() const -> std::basic_string_view<CharT, Traits> {
+            if (auto text = small()) return text->view();
+            auto &tree = std::get<TreeType>(storage);
+            if (auto single = tree.contiguous()) return *single;
+            auto revision = tree.revision();
+            auto cached = flat_cache.load(std::memory_order_acquire);
+            if (!cached || cached->revision != revision) {
+                ROPE_TRACE_EVENT(Flatten, size() * sizeof(CharT));
+                auto fresh = std::allocate_shared<const FlatCopy>(allocator, FlatCopy{to_string(), revision});
+                // a reader that lost the race takes the winner's copy, both are of this revision
+                cached = flat_cache.compare_exchange_strong(cached, fresh, std::memory_order_acq_rel) ? fresh : cached;
+            }
+            return cached->text;
+        }
+        // view(), first moving a short rope inline (at most small_size characters) or into a single leaf (at most max_leaf_size) so no copy is kept
+        auto flatten() -> std::basic_string_view<CharT, Traits> {
+            settle(small_size);
+            if (!small()) rope().collapse();
+            return view();
+        }
+        // Copy of the text as a std::basic_string, one exact allocation and a block copy per leaf
+        auto to_string() const -> StringType {
+            StringType result(get_allocator());
+            append_to(result);
+            return result;
+        }
+        // Call fn(view) for the pieces of [pos, pos + count) in order, each viewing one leaf in place
+        template<typename F>
+        auto for_each_chunk(F &&fn, size_type pos = 0, size_type count = npos) const -> void {
+            if (pos >= size()) return;
+            count = std::min(count, size() - pos);
+            if (auto text = small()) return fn(text->view().substr(pos, count));
+            visitFrom(0, pos, count, [&](const CharT *chunk, size_type n) {
+                fn(std::basic_string_view<CharT, Traits>(chunk, n));
+                return true;
+            });
+        }
+        /*
+         * Lazy ranges of the pieces between delimiters, each a BasicStringView of this string (see StringView.h).
+         * The leaves are scanned once as the range is walked, nothing is copied or allocated per piece.
+         */
+        auto split(CharT delim) const -> BasicSplitView<CharT, Traits, Allocator, Policy> {
+            return BasicStringView<CharT, Traits, Allocator, Policy>(*this).split(delim);
+        }
+        auto split(std::basic_string_view<CharT, Traits> delim) const -> BasicSplitView<CharT, Traits, Allocator, Policy> {
+            return BasicStringView<CharT, Traits, Allocator, Policy>(*this).split(delim);
+        }
+        auto split_any(std::basic_string_view<CharT, Traits> set) const -> BasicSplitView<CharT, Traits, Allocator, Policy> {
+            return BasicStringView<CharT, Traits, Allocator, Policy>(*this).split_any(set);
+        }
+        auto lines() const -> BasicSplitView<CharT, Traits, Allocator, Policy> {
+            return BasicStringView<CharT, Traits, Allocator, Policy>(*this).lines();
+        }
+        auto append_to(StringType &out) const -> void {
+            if (auto text = small()) {
+                out.append(text->view());
+                return;
+            }
+            out.reserve(out.size() + size());
+            for (auto &root : tree().getRoots())
+                for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) out.append(leaf->str);
         }
         /*Get C String. Note to use output to print into stream instead */
         auto c_str() const -> std::unique_ptr<CharT[], std::function<void(CharT*)>> {
-            using AllocTraits = std::allocator_traits<Allocator>;
-            Allocator alloc;
+            ROPE_TRACE_SCOPE(CStr, size() * sizeof(CharT));
+            Allocator alloc = allocator;
 
-            std::size_t len = tree.size();
+            std::size_t len = size();
             CharT* cstr = AllocTraits::allocate(alloc, len + 1);
 
             std::size_t pos = 0;
-            for (auto& root : tree.getRoots()) {
+            if (auto text = small()) Traits::copy(cstr, text->data.data(), len);
+            else for (auto& root : tree().getRoots()) {
                 for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) {
                     std::copy(leaf->str.begin(), leaf->str.end(), cstr + pos);
                     pos += leaf->str.size();
@@ -361,102 +531,120 @@ namespace Rope {
             );
         }
         auto begin() -> iterator<CharT> {
-            return iterator<CharT>(tree, 0);
+            return iteratorAt<iterator<CharT>>(0);
         }
         auto begin() const -> const_iterator {
-            return const_iterator(tree, 0);
+            return iteratorAt<const_iterator>(0);
         }
         auto end() -> iterator<CharT> {
-            return iterator<CharT>(tree, tree.size());
+            return iteratorAt<iterator<CharT>>(size());
         }
         auto end() const -> const_iterator {
-            return const_iterator(tree, tree.size());
+            return iteratorAt<const_iterator>(size());
         }
         auto cbegin() const -> const_iterator {
-            return const_iterator(tree, 0);
+            return iteratorAt<const_iterator>(0);
         }
         auto cend() const -> const_iterator {
-            return const_iterator(tree, tree.size());
+            return iteratorAt<const_iterator>(size());
         }
         auto rbegin() -> reverse_iterator<CharT> {
-            return reverse_iterator<CharT>(tree, 0);
+            return iteratorAt<reverse_iterator<CharT>>(0);
         }
         auto rend() -> reverse_iterator<CharT> {
-            return reverse_iterator<CharT>(tree, tree.size());
+            return iteratorAt<reverse_iterator<CharT>>(size());
         }
         auto crbegin() const -> reverse_const_iterator {
-            return reverse_const_iterator(tree, 0);
+            return iteratorAt<reverse_const_iterator>(0);
         }
         auto crend() const -> reverse_const_iterator {
-            return reverse_const_iterator(tree, tree.size());
+            return iteratorAt<reverse_const_iterator>(size());
         }
         auto empty() const -> bool {
-            return tree.getRoots().front().second == 0;
+            return size() == 0;
         }
         auto size() const -> size_type {
-            return tree.size();
+            if (auto text = small()) return text->size;
+            return std::get<TreeType>(storage).size();
         }
         auto length() const -> size_type {
             return size();
         }
+        // A tree with anchors or a journal is cleared in place so they see the change, anything else goes back inline
         auto clear() -> void {
-            tree.clear();
+            if (auto tree = std::get_if<TreeType>(&storage); tree && tree->carriesState()) tree->clear();
+            else storage.template emplace<SmallText>();
+            invalidate();
         }
         // (1) insert count copies of a char at index
         auto insert(size_type index, size_type count, CharT ch) -> BasicString& {
-            for (size_type i = 0; i < count; ++i)
-                tree.insert(index + i, StringType(1, ch));
+            if (auto text = smallFor(index, 0, count)) {
+                ROPE_TRACE_SCOPE(Insert, count * sizeof(CharT));
+                editSmall(*text, index, 0, count, [&](CharT *at) { Traits::assign(at, count, ch); });
+            } else {
+                rope().insert(index, count, ch);
+            }
             return *this;
         }
 
         // (2) insert null-terminated char array at index
         auto insert(size_type index, const CharT* s) -> BasicString& {
-            tree.insert(index, StringType(s));
+            insertText(index, s);
             return *this;
         }
 
         // (3) insert char array with count at index
         auto insert(size_type index, const CharT* s, size_type count) -> BasicString& {
-            tree.insert(index, StringType(s, count));
+            insertText(index, {s, count});
             return *this;
         }
 
         // (4) insert whole BasicString at index
         auto insert(size_type index, const BasicString& str) -> BasicString& {
-            for (auto& root : str.tree.getRoots())
-                tree.insert(index, root->str);
+            if (auto text = str.small()) {
+                insertText(index, text->view());
+                return *this;
+            }
+            ROPE_TRACE_EVENT(Flatten, str.size() * sizeof(CharT));
+            StringType flat(str.size(), CharT(), get_allocator());
+            str.copy(flat.data(), flat.size());
+            insertText(index, flat);
+            return *this;
+        }
+
+        // (4b) insert an rvalue std::basic_string, its buffer is adopted at the end and copied elsewhere
+        auto insert(size_type index, StringType&& str) -> BasicString& {
+            if (index >= size()) pushOwned(std::move(str));
+            else insertText(index, str);
             return *this;
         }
 
         // (5) insert part of BasicString [s_index, s_index+count) at index
         auto insert(size_type index, const BasicString& str, size_type s_index, size_type count = std::string::npos) -> BasicString& {
-            StringType tmp = str.tree.substr(s_index, count);
-            tree.insert(index, tmp);
-            return *this;
+            return insert(index, str.substr(s_index, count));
         }
 
         // (6) insert single char at iterator position
         auto insert(iterator<CharT> pos, CharT ch) -> iterator<CharT> {
             size_type index = pos.position();
             insert(index, 1, ch);
-            return iterator<CharT>(tree, index);
+            return iteratorAt<iterator<CharT>>(index);
         }
 
         // (7) insert count copies of char at iterator position
         auto insert(const_iterator pos, size_type count, CharT ch) -> iterator<CharT> {
             size_type index = pos.position();
             insert(index, count, ch);
-            return iterator<CharT>(tree, index);
+            return iteratorAt<iterator<CharT>>(index);
         }
 
         // (8) insert range [first, last) at iterator position
         template<typename InputIt>
         auto insert(const_iterator pos, InputIt first, InputIt last) -> iterator<CharT> {
             size_type index = pos.position();
-            for (auto it = first; it != last; ++it) {
-                tree.insert(index++, StringType(1, *it));
-            }
-            return iterator<CharT>(tree, pos.position());
+            rope().insert(index, first, last);
+            settle();
+            return iteratorAt<iterator<CharT>>(index);
         }
 
         // (9) insert initializer_list at iterator position
@@ -467,43 +655,38 @@ namespace Rope {
         // (10) insert StringViewLike at index
         template<typename SV>
         auto insert(size_type index, const SV& t) -> BasicString& {
-            tree.insert(index, StringType(t));
+            if constexpr (std::is_convertible_v<const SV&, std::basic_string_view<CharT, Traits>>)
+                insertText(index, std::basic_string_view<CharT, Traits>(t));
+            else
+                insertText(index, StringType(t));
             return *this;
         }
         // (10b) insert part of StringViewLike at index
         template<typename SV>
+        requires std::is_convertible_v<const SV&, std::basic_string_view<CharT, Traits>> && (!std::is_convertible_v<const SV&, const CharT*>)
         auto insert(size_type index, const SV& t, size_type t_index, size_type count = npos) -> BasicString& {
-            tree.insert(index, StringType(t, t_index, count));
+            insertText(index, std::basic_string_view<CharT, Traits>(t).substr(t_index, count));
             return *this;
         }
 #ifdef __cpp_lib_from_range
         template<std::ranges::range R>
         requires std::convertible_to<std::ranges::range_value_t<R>, CharT>
-        auto insert_range(const_iterator pos, R&& rg) -> iterator {
-            // compute index from iterator
-            size_type index = pos - cbegin();
-
-            // construct a temporary BasicString from the range
-            BasicString tmp(std::from_range, std::forward<R>(rg), this->get_allocator());
-
-            // insert it at index
-            insert(index, tmp);
-
-            // return iterator to the first inserted element
-            return begin() + index;
+        auto insert_range(const_iterator pos, R&& rg) -> iterator<CharT> {
+            size_type index = pos.position();
+            rope().insert(index, std::ranges::begin(rg), std::ranges::end(rg));
+            settle();
+            return iteratorAt<iterator<CharT>>(index);
         }
 #endif
         auto erase(size_type index = 0, size_type count = StringType::npos) -> void {
-            size_type total = size();
-            if (index >= total) return;
-            StringType flat;
-            flat.resize(total);
-            copy(flat.data(), total, 0);
-            flat.erase(index, count);
-            tree.clear();
-            if (!flat.empty()) {
-                tree.push(flat);
+            if (auto text = small()) {
+                if (index >= text->size || count == 0) return;
+                ROPE_TRACE_SCOPE(Erase, std::min(count, text->size - index) * sizeof(CharT));
+                editSmall(*text, index, count, 0, [](CharT*) {});
+                return;
             }
+            rope().erase(index, count);
+            settle();
         }
         auto erase(const_iterator pos) -> void {
             auto idx = pos.position();
@@ -516,224 +699,180 @@ namespace Rope {
             erase(b, e - b);
         }
         auto push_back(CharT ch) -> void {
-            tree.push(StringType (1, ch));
+            if (auto text = smallFor(npos, 0, 1)) {
+                ROPE_TRACE_SCOPE(Push, sizeof(CharT));
+                text->data[text->size++] = ch;
+                invalidate();
+                return;
+            }
+            rope().push(ch);
         }
         auto pop_back() -> void {
-            auto root = tree.getRoots().back().first;
-            while (root->right) {
-                root = root->right;
+            if (auto text = small()) {
+                if (text->size) --text->size;
+                invalidate();
+                return;
             }
-            root->str.pop_back();
-            tree.getRoots().back().second--;
+            auto &held = rope();
+            held.popBack();
+            // only a single root is cheap to measure, pop_back stays O(1)
+            if (held.getRoots().size() == 1) settle();
         }
         auto append(size_type count, CharT ch) -> BasicString& {
-            tree.push(StringType(count, ch));
+            if (auto text = smallFor(npos, 0, count)) {
+                ROPE_TRACE_SCOPE(Push, count * sizeof(CharT));
+                editSmall(*text, npos, 0, count, [&](CharT *at) { Traits::assign(at, count, ch); });
+            } else {
+                rope().push(count, ch);
+            }
             return *this;
         }
         auto append(CharT *s, size_type count) -> BasicString& {
-            tree.push(StringType {s, count});
+            pushText({s, count});
             return *this;
         }
         auto append(CharT *s) -> BasicString& {
-            tree.push(StringType {s});
+            pushText(s);
+            return *this;
+        }
+        auto append(std::span<const CharT> s) -> BasicString& {
+            pushText({s.data(), s.size()});
             return *this;
         }
         template<typename SV>
         auto append(const SV &t) -> BasicString& {
-            tree.push(StringType(t));
+            pushView(t);
             return *this;
         }
         template<typename SV>
+        requires std::is_convertible_v<const SV&, std::basic_string_view<CharT, Traits>> && (!std::is_convertible_v<const SV&, const CharT*>)
         auto append(const SV &t, size_type pos, size_type count = StringType::npos) -> BasicString& {
-            tree.push(StringType(t, pos, count));
+            pushText(std::basic_string_view<CharT, Traits>(t).substr(pos, count));
             return *this;
         }
         auto append(const StringType &s) -> BasicString& {
-            tree.push(s);
+            pushText(s);
+            return *this;
+        }
+        // Appends the buffer of `s` itself as a leaf, no characters are copied
+        auto append(StringType &&s) -> BasicString& {
+            pushOwned(std::move(s));
             return *this;
         }
         auto append(const StringType &s, size_type pos, size_type count) -> BasicString& {
-            tree.push(StringType(s, pos, count));
+            pushText(std::basic_string_view<CharT, Traits>(s).substr(pos, count));
+            return *this;
+        }
+        // Move the roots of `str` to the end, no text is copied. A small `str` is copied, it has no roots
+        auto append(BasicString &&str) -> BasicString& {
+            if (auto text = str.small()) pushText(text->view());
+            else rope().splice(std::move(str.rope()));
             return *this;
         }
         template< class InputIt >
         auto append(InputIt begin, InputIt end) -> BasicString& {
-            tree.push(StringType(begin, end));
+            pushRange(begin, end);
             return *this;
         }
         auto append(std::initializer_list<CharT> ilist) -> BasicString& {
-            tree.push(StringType(ilist));
+            pushText({ilist.begin(), ilist.size()});
             return *this;
         }
 #ifdef __cpp_lib_from_range
         template<std::ranges::range R>
         requires std::convertible_to<std::ranges::range_value_t<R>, CharT>
-        auto append_range(const_iterator pos, R&& rg) -> iterator {
-            tree.push(StringType(pos, rg));
+        auto append_range(R&& rg) -> BasicString& {
+            pushRange(std::ranges::begin(rg), std::ranges::end(rg));
             return *this;
         }
 #endif
-        auto replace(size_type pos, size_type count, const BasicString &str) -> BasicString {
-            NodeType *root = tree.getRootByIndex(pos);
-            NodeType *node = root->getLeafByIndex(pos);
-            node->str.replace(pos, count, str);
+        auto replace(size_type pos, size_type count, const BasicString &str) -> BasicString& {
+            if (auto text = str.small()) {
+                replaceText(pos, count, text->view());
+                return *this;
+            }
+            ROPE_TRACE_EVENT(Flatten, str.size() * sizeof(CharT));
+            StringType repl;
+            repl.resize(str.size());
+            str.copy(repl.data(), repl.size(), 0);
+            replaceText(pos, count, repl);
             return *this;
         }
         auto replace(const_iterator first, const_iterator last, const BasicString &str) -> BasicString& {
-                    auto b = first.position();
-                    auto e = last.position();
-                    if (e < b) std::swap(b, e);
-                    size_type total = size();
-                    std::basic_string<CharT, Traits, Allocator> flat;
-                    flat.resize(total);
-                    copy(flat.data(), total, 0);
-                    // build replacement from str by flattening
-                    std::basic_string<CharT, Traits, Allocator> repl;
-                    repl.resize(str.size());
-                    str.copy(repl.data(), repl.size(), 0);
-                    flat.replace(b, e - b, repl);
-                    tree.clear();
-                    if (!flat.empty()) tree.push(flat);
-                    return *this;
-                }
-        auto replace(size_type pos, size_type count, const BasicString& str, size_type pos2, size_type count2 = StringType::npos) {
-            NodeType *root = tree.getRootByIndex(pos);
-            NodeType *node = root->getLeafByIndex(pos);
-            node->str.replace(pos, count, str, pos2, count2);
+            auto [b, e] = bounds(first, last);
+            return replace(b, e - b, str);
+        }
+        auto replace(size_type pos, size_type count, const BasicString& str, size_type pos2, size_type count2 = StringType::npos) -> BasicString& {
+            StringType repl;
+            repl.resize(std::min(count2, str.size() - std::min(pos2, str.size())));
+            ROPE_TRACE_EVENT(Flatten, repl.size() * sizeof(CharT));
+            str.copy(repl.data(), repl.size(), pos2);
+            replaceText(pos, count, repl);
             return *this;
         }
         // (4) replace(pos, count, const CharT* cstr, size_type count2)
         auto replace(size_type pos, size_type count, const CharT* cstr, size_type count2) -> BasicString& {
-            // Flatten, replace, rebuild
-            size_type total = size();
-            if (pos > total) return *this; // nothing to do if pos beyond end
-            StringType flat;
-            flat.resize(total);
-            copy(flat.data(), total, 0);
-            flat.replace(pos, count, cstr, count2);
-            tree.clear();
-            if (!flat.empty()) tree.push(flat);
+            if (pos > size()) return *this; // nothing to do if pos beyond end
+            replaceText(pos, count, {cstr, count2});
             return *this;
         }
         auto replace(const_iterator first, const_iterator last, const CharT* cstr, size_type count2 ) -> BasicString& {
-            auto b = first.position();
-            auto e = last.position();
-            if (e < b) std::swap(b, e);
-            size_type total = size();
-            std::basic_string<CharT, Traits, Allocator> flat;
-            flat.resize(total);
-            copy(flat.data(), total, 0);
-            flat.replace(b, e - b, cstr, count2);
-            tree.clear();
-            if (!flat.empty()) tree.push(flat);
+            auto [b, e] = bounds(first, last);
+            replaceText(b, e - b, {cstr, count2});
             return *this;
         }
         // (6) replace(pos, count, const CharT* cstr)
         auto replace(size_type pos, size_type count, const CharT* cstr) -> BasicString& {
-            // Flatten, replace, rebuild
-            size_type total = size();
-            if (pos > total) return *this; // nothing to do if pos beyond end
-            StringType flat;
-            flat.resize(total);
-            copy(flat.data(), total, 0);
-            flat.replace(pos, count, cstr);
-            tree.clear();
-            if (!flat.empty()) tree.push(flat);
+            if (pos > size()) return *this; // nothing to do if pos beyond end
+            replaceText(pos, count, cstr);
             return *this;
         }
         auto replace( const_iterator first, const_iterator last, const CharT* cstr) -> BasicString& {
-            auto b = first.position();
-            auto e = last.position();
-            if (e < b) std::swap(b, e);
-            size_type total = size();
-            std::basic_string<CharT, Traits, Allocator> flat;
-            flat.resize(total);
-            copy(flat.data(), total, 0);
-            flat.replace(b, e - b, cstr);
-            tree.clear();
-            if (!flat.empty()) tree.push(flat);
+            auto [b, e] = bounds(first, last);
+            replaceText(b, e - b, cstr);
             return *this;
         }
         // (8) replace(pos, count, size_type count2, CharT ch)
         auto replace(size_type pos, size_type count, size_type count2, CharT ch) -> BasicString& {
-            StringType tmp(count2, ch);
-            NodeType* root = tree.getRootByIndex(pos);
-            NodeType* node = root->getLeafByIndex(pos);
-            node->str.replace(pos, count, tmp);
+            replaceText(pos, count, StringType(count2, ch, allocator));
             return *this;
         }
         auto replace(const_iterator first, const_iterator last, size_type count2, CharT ch ) -> BasicString& {
-            auto b = first.position();
-            auto e = last.position();
-            if (e < b) std::swap(b, e);
-            size_type total = size();
-            std::basic_string<CharT, Traits, Allocator> flat;
-            flat.resize(total);
-            copy(flat.data(), total, 0);
-            std::basic_string<CharT, Traits, Allocator> repl(count2, ch);
-            flat.replace(b, e - b, repl);
-            tree.clear();
-            if (!flat.empty()) tree.push(flat);
+            auto [b, e] = bounds(first, last);
+            replaceText(b, e - b, StringType(count2, ch, allocator));
             return *this;
         }
         template<typename InputIt>
         auto replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2) -> BasicString& {
-            auto b = first.position();
-            auto e = last.position();
-            if (e < b) std::swap(b, e);
-            size_type total = size();
-            std::basic_string<CharT, Traits, Allocator> flat;
-            flat.resize(total);
-            copy(flat.data(), total, 0);
-            std::basic_string<CharT, Traits, Allocator> repl(first2, last2);
-            flat.replace(b, e - b, repl);
-            tree.clear();
-            if (!flat.empty()) tree.push(flat);
+            auto [b, e] = bounds(first, last);
+            replaceText(b, e - b, StringType(first2, last2, allocator));
             return *this;
         }
 
         // (11) replace(pos, count, std::initializer_list<CharT> ilist)
         auto replace(size_type pos, size_type count, std::initializer_list<CharT> ilist) -> BasicString& {
-            StringType tmp(ilist);
-            NodeType* root = tree.getRootByIndex(pos);
-            NodeType* node = root->getLeafByIndex(pos);
-            node->str.replace(pos, count, tmp);
+            replaceText(pos, count, {ilist.begin(), ilist.size()});
             return *this;
         }
 
         // (12) replace(pos, count, const StringViewLike& t)
         template<class StringViewLike>
         auto replace(size_type pos, size_type count, const StringViewLike& t) -> BasicString& {
-            StringType tmp(t);
-            NodeType* root = tree.getRootByIndex(pos);
-            NodeType* node = root->getLeafByIndex(pos);
-            node->str.replace(pos, count, tmp);
+            replaceView(pos, count, t);
             return *this;
         }
         template<class StringViewLike>
         auto replace( const_iterator first, const_iterator last, const StringViewLike& t) -> BasicString& {
-            auto b = first.position();
-            auto e = last.position();
-            if (e < b) std::swap(b, e);
-            size_type total = size();
-            std::basic_string<CharT, Traits, Allocator> flat;
-            flat.resize(total);
-            copy(flat.data(), total, 0);
-            std::basic_string<CharT, Traits, Allocator> repl(t);
-            flat.replace(b, e - b, repl);
-            tree.clear();
-            if (!flat.empty()) tree.push(flat);
+            auto [b, e] = bounds(first, last);
+            replaceView(b, e - b, t);
             return *this;
         }
         // (14) replace(pos, count, const StringViewLike& t, size_type pos2, size_type count2 = StringType::npos)
         template<class StringViewLike>
+        requires std::is_convertible_v<const StringViewLike&, std::basic_string_view<CharT, Traits>>
         auto replace(size_type pos, size_type count, const StringViewLike& t,
                      size_type pos2, size_type count2 = StringType::npos) -> BasicString& {
-            StringType tmp(t);
-            tmp = tmp.substr(pos2, count2);
-            NodeType* root = tree.getRootByIndex(pos);
-            NodeType* node = root->getLeafByIndex(pos);
-            node->str.replace(pos, count, tmp);
+            replaceText(pos, count, std::basic_string_view<CharT, Traits>(t).substr(pos2, count2));
             return *this;
         }
 #ifdef __cpp_lib_from_range
@@ -744,15 +883,21 @@ namespace Rope {
         }
 #endif
         auto copy(CharT* dest, size_type count, size_type pos = 0) const -> size_type {
-            if (pos >= tree.size()) {
+            if (pos >= size()) {
                 return 0; // nothing to copy if starting beyond size
             }
+            ROPE_TRACE_SCOPE(Copy, std::min(count, size() - pos) * sizeof(CharT));
+            if (auto text = small()) {
+                auto n = std::min(count, text->size - pos);
+                Traits::copy(dest, text->data.data() + pos, n);
+                return n;
+            }
 
             size_type written = 0;      // number of chars written
             size_type remaining = count; // how many still need copying
             size_type global_index = 0;  // global position while walking leaves
 
-            for (auto& root : tree.getRoots()) {
+            for (auto& root : tree().getRoots()) {
                 for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) {
                     auto leaf_size = leaf->str.size();
 
@@ -782,6 +927,7 @@ namespace Rope {
             return written;
         }
         auto find(const BasicString& str, size_type pos = 0) const -> size_type {
+            ROPE_TRACE_SCOPE(Find, size() * sizeof(CharT));
             if (str.empty()) {
                 return pos <= size() ? pos : StringType::npos;
             }
@@ -809,82 +955,76 @@ namespace Rope {
             return StringType::npos;
         }
         auto operator=(const BasicString& other) -> BasicString& {
-            tree = other.tree;
+            assignFrom(other);
             return *this;
         }
-        auto operator=(const BasicString&& other) noexcept -> BasicString& {
-            tree = std::move(other.tree);
+        auto operator=(BasicString&& other) noexcept(nothrow_move_assign) -> BasicString& {
+            assignFrom(std::move(other));
             return *this;
         }
+        auto operator=(StringType&& str) -> BasicString& {
+            return assign(std::move(str));
+        }
         auto operator=(const CharT *s) -> BasicString& {
-            tree.clear();
-            tree.push(StringType(s));
+            assignText(s);
             return *this;
         }
         auto operator=(CharT ch) -> BasicString& {
-            tree.clear();
-            tree.push(StringType(1, ch));
+            assignText({&ch, 1});
             return *this;
         }
         auto operator=(std::initializer_list<CharT> ilist) {
-            tree.clear();
-            tree.push(StringType(ilist));
+            assignText({ilist.begin(), ilist.size()});
         }
         template<class StringViewLike>
         auto operator=(const StringViewLike& t) -> BasicString& {
-            tree.clear();
-            tree.push(StringType(t));
+            assignView(t);
             return *this;
         }
         auto operator=(std::nullptr_t) -> BasicString& = delete;
+        // Comparisons walk the leaves in place, an inline text is compared as it is
         auto operator==(const BasicString& other) const -> bool {
             if (size() != other.size()) {
                 return false;
             }
-            auto this_ptr = begin();
-            auto other_ptr = other.begin();
-            while (this_ptr != end()) {
-                if (*this_ptr++ != *other_ptr++) {
-                    return false;
+            if (auto text = other.small()) return equals(text->view());
+            if (auto text = small()) return other.equals(text->view());
+            auto theirs = BasicStringView<CharT, Traits, Allocator, Policy>(other).cursor();
+            std::basic_string_view<CharT, Traits> piece;
+            bool equal = true;
+            visitFrom(0, 0, size(), [&](const CharT *chunk, size_type n) {
+                while (n > 0) {
+                    if (piece.empty()) piece = theirs.next();
+                    auto take = std::min(n, piece.size());
+                    if (Traits::compare(chunk, piece.data(), take) != 0) return equal = false;
+                    chunk += take;
+                    n -= take;
+                    piece.remove_prefix(take);
                 }
-            }
-            return true;        }
+                return true;
+            });
+            return equal;
+        }
         auto operator==(const StringType &other) const -> bool {
-            if (size() != other.size()) {
-                return false;
-            }
-            auto this_ptr = begin();
-            auto other_ptr = other.begin();
-            while (this_ptr != end()) {
-                if (!Traits::eq(*this_ptr, *other_ptr)) {
-                    return false;
-                }
-                ++this_ptr;
-                ++other_ptr;
-            }
-            return true;
+            return size() == other.size() && equals(other);
         }
         auto operator==(const CharT *s) const -> bool {
             if (!s) return false;
-            size_type n = Traits::length(s);
-            if (size() != n) {
-                return false;
-            }
-            // Compare without relying on iterators
-            std::vector<CharT> buf(n);
-            copy(buf.data(), n, 0);
-            for (size_type i = 0; i < n; ++i) {
-                if (!Traits::eq(buf[i], s[i])) return false;
-            }
-            return true;
+            std::basic_string_view<CharT, Traits> text(s);
+            return size() == text.size() && equals(text);
         }
         auto operator==(std::nullptr_t) const -> bool = delete;
 
         // operator+= overloads
         auto operator+=(const BasicString& str) -> BasicString& {
-            // append contents of another rope without flattening
-            for (auto& root : str.tree.getRoots()) {
-                tree.push(root->str);
+            // append contents of another rope without flattening, appending a rope to itself copies it first
+            if (auto text = str.small()) {
+                pushText(text->view());
+            } else if (&str == this) {
+                pushText(str.to_string());
+            } else {
+                for (auto& root : str.tree().getRoots())
+                    for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) pushText(leaf->str);
             }
             return *this;
         }
@@ -892,18 +1032,22 @@ namespace Rope {
             push_back(ch);
             return *this;
         }
+        auto operator+=(StringType&& str) -> BasicString& {
+            pushOwned(std::move(str));
+            return *this;
+        }
         auto operator+=(const CharT* s) -> BasicString& {
             if (!s) return *this; // ignore null pointer
-            tree.push(StringType(s));
+            pushText(s);
             return *this;
         }
         auto operator+=(std::initializer_list<CharT> ilist) -> BasicString& {
-            tree.push(StringType(ilist));
+            pushText({ilist.begin(), ilist.size()});
             return *this;
         }
         template<class StringViewLike>
         auto operator+=(const StringViewLike& t) -> BasicString& {
-            tree.push(StringType(t));
+            pushView(t);
             return *this;
         }
         // resize to count, filling with value-initialized CharT if growing
@@ -933,6 +1077,7 @@ namespace Rope {
             std::basic_string<CharT, Traits, Allocator> buf;
             buf.resize(count);
             size_type to_copy = std::min(count, size());
+            ROPE_TRACE_EVENT(Flatten, to_copy * sizeof(CharT));
             if (to_copy) {
                 copy(buf.data(), to_copy, 0);
             }
@@ -940,29 +1085,110 @@ namespace Rope {
             auto new_size = static_cast<size_type>(op(buf.data(), count));
             if (new_size > count) new_size = count;
             // rebuild rope from buffer prefix
-            tree.clear();
-            if (new_size) {
-                tree.push(std::basic_string<CharT, Traits, Allocator>(buf.data(), new_size));
-            }
+            buf.resize(new_size);
+            replaceText(0, size(), buf);
+        }
+        /*
+         * Apply a batch of edits (multi-cursor typing, replace-all) as one transaction.
+         * Offsets refer to the string before the call and edits must not overlap,
+         * otherwise nothing is changed and std::invalid_argument is thrown.
+         */
+        auto apply(std::span<const Edit> edits) -> BasicString& {
+            rope().apply(edits);
+            settle();
+            return *this;
+        }
+        /*
+         * Replace every occurrence of `pattern`, found left to right without overlaps, and return their number.
+         * The leaves are scanned once and the occurrences applied as one batch (see apply), so roots without
+         * one are reused as they are. An empty pattern matches nothing.
+         */
+        auto replace_all(std::basic_string_view<CharT, Traits> pattern, std::basic_string_view<CharT, Traits> with) -> size_type {
+            std::vector<Edit> edits;
+            forEachMatch(pattern, [&](size_type pos) { edits.push_back({pos, pattern.size(), with}); });
+            applyMatches(edits);
+            return edits.size();
+        }
+        // fn(pos) returns the replacement of the occurrence at `pos`, as anything a string view converts from; it sees the string unchanged
+        template<typename F>
+        requires std::invocable<F&, size_type>
+        auto replace_all(std::basic_string_view<CharT, Traits> pattern, F &&fn) -> size_type {
+            std::vector<Edit> edits;
+            std::vector<size_type> ends;
+            StringType texts(allocator);
+            forEachMatch(pattern, [&](size_type pos) {
+                texts += std::basic_string_view<CharT, Traits>(std::invoke(fn, pos));
+                edits.push_back({pos, pattern.size(), {}});
+                ends.push_back(texts.size());
+            });
+            // the replacements share one buffer, they are viewed once it stopped growing
+            for (size_type i = 0, begin = 0; i < edits.size(); begin = ends[i++])
+                edits[i].text = std::basic_string_view<CharT, Traits>(texts).substr(begin, ends[i] - begin);
+            applyMatches(edits);
+            return edits.size();
+        }
+        /*
+         * Merge fragmented leaves and undersized roots. With an automatic policy every edit
+         * also repacks the roots it touched once their leaves fall below policy.min_fill.
+         */
+        auto compact() -> void {
+            if (!small()) rope().compact();
+        }
+        // compact(), and a rope of at most small_size characters moves back inline
+        auto shrink_to_fit() -> void {
+            settle(small_size);
+            if (!small()) rope().compact();
+        }
+        // Leaf and root counts, fill histogram and memory breakdown, for metrics and tuning the size macros
+        auto stats() const -> Stats {
+            return tree().stats();
+        }
+        auto set_compact_policy(CompactPolicy policy) -> void {
+            rope().setCompactPolicy(policy);
         }
-        // swap contents
+        auto compact_policy() const -> CompactPolicy {
+            return tree().compactPolicy();
+        }
+        // swap contents, anchors follow the content they were registered on
         auto swap(BasicString& other) noexcept -> void {
-            using std::swap;
-            swap(this->tree, other.tree);
+            auto mine = std::get_if<TreeType>(&storage), theirs = std::get_if<TreeType>(&other.storage);
+            if (mine && theirs) mine->swap(*theirs);
+            else storage.swap(other.storage);
+            if constexpr (AllocTraits::propagate_on_container_swap::value) std::swap(allocator, other.allocator);
+            invalidate();
+            other.invalidate();
+        }
+        /*
+         * Anchors: positions kept up to date by every edit of this string.
+         * Gravity::Left stays before text inserted at the anchor, Gravity::Right moves past it.
+         */
+        auto anchor(size_type pos, Gravity gravity = Gravity::Right) -> Anchor {
+            return rope().anchor(pos, gravity);
+        }
+        auto resolve(const Anchor &anchor) const -> size_type {
+            return tree().resolve(anchor);
+        }
+        /*
+         * Change journal: subscribe a cursor, edit, then pull the coalesced dirty ranges
+         * to reprocess only what changed.
+         */
+        auto enable_journal() -> Journal& {
+            return rope().enableJournal();
+        }
+        auto journal() const -> Journal* {
+            if (small()) return nullptr;
+            return tree().journal();
         }
         // substring
         auto substr(size_type pos = 0, size_type count = npos) const -> BasicString {
             size_type total = size();
             if (pos > total) pos = total; // yield empty
             size_type len = (count == npos) ? (total - pos) : std::min(count, total - pos);
-            std::basic_string<CharT, Traits, Allocator> flat;
-            flat.resize(total);
-            copy(flat.data(), total, 0);
             BasicString result;
             if (len) {
-                result.assign(flat.data() + pos, len);
-            } else {
-                result.clear();
+                StringType part(len, CharT(), get_allocator());
+                copy(part.data(), len, pos);
+                result.assign(part.data(), len);
             }
             return result;
         }
@@ -1062,18 +1288,16 @@ namespace Rope {
         }
         // find overloads using flattened string for simplicity
         auto find(CharT ch, size_type pos = 0) const -> size_type {
+            ROPE_TRACE_SCOPE(Find, size() * sizeof(CharT));
             size_type n = size();
             for (size_type i = pos; i < n; ++i) if (Traits::eq(getAtPos(i), ch)) return i;
             return npos;
         }
         auto find(const std::basic_string<CharT, Traits, Allocator>& s, size_type pos = 0) const -> size_type {
-            // use flattened haystack to delegate to std::basic_string::find
+            // search the cached contiguous view
             if (s.empty()) return pos <= size() ? pos : npos;
-            std::basic_string<CharT, Traits, Allocator> flat;
-            size_type total = size();
-            flat.resize(total);
-            copy(flat.data(), total, 0);
-            return flat.find(s, pos);
+            ROPE_TRACE_SCOPE(Find, size() * sizeof(CharT));
+            return view().find(s, pos);
         }
         auto find(const CharT* s, size_type pos = 0) const -> size_type {
             if (!s) return npos;
@@ -1091,12 +1315,8 @@ namespace Rope {
             return npos;
         }
         auto rfind(const std::basic_string<CharT, Traits, Allocator>& s, size_type pos = npos) const -> size_type {
-            // flatten
-            std::basic_string<CharT, Traits, Allocator> flat;
-            size_type total = size();
-            flat.resize(total);
-            copy(flat.data(), total, 0);
-            return flat.rfind(s, pos);
+            ROPE_TRACE_SCOPE(Find, size() * sizeof(CharT));
+            return view().rfind(s, pos);
         }
         auto rfind(const CharT* s, size_type pos = npos) const -> size_type {
             if (!s) return npos;
@@ -1152,11 +1372,512 @@ namespace Rope {
             if (!s) return npos;
             return find_last_not_of(std::basic_string<CharT, Traits, Allocator>(s), pos);
         }
+        auto count(CharT ch) const -> size_type {
+            size_type result = 0;
+            visitFrom(0, 0, size(), [&](const CharT *chunk, size_type n) {
+                result += countIn(chunk, n, ch);
+                return true;
+            });
+            return result;
+        }
+        /*
+         * Parallel overloads: take a std::execution policy or an Executor (see Parallel.h)
+         * and scan runs of roots concurrently, each run covers about parallel_grain characters.
+         */
+        static constexpr size_type parallel_grain = Rope::parallel_grain;
+
+        template<ParallelContext Context>
+        auto find(Context &&context, CharT ch, size_type pos = 0) const -> size_type {
+            ROPE_TRACE_SCOPE(Find, size() * sizeof(CharT));
+            auto runs = segments(pos, size());
+            std::atomic<size_type> best = npos;
+            parallelFor(std::forward<Context>(context), runs.size(), [&](std::size_t i) {
+                auto &run = runs[i];
+                if (run.offset >= best.load(std::memory_order_relaxed)) return;
+                auto at = run.offset;
+                visitFrom(run.root, run.skip, run.length, [&](const CharT *chunk, size_type n) {
+                    if (auto hit = Traits::find(chunk, n, ch)) {
+                        lower(best, at + static_cast<size_type>(hit - chunk));
+                        return false;
+                    }
+                    at += n;
+                    return true;
+                });
+            });
+            return best.load();
+        }
+        // Runs also read the needle length - 1 characters past their end, so matches crossing runs are found
+        template<ParallelContext Context>
+        auto find(Context &&context, const std::basic_string<CharT, Traits, Allocator>& s, size_type pos = 0) const -> size_type {
+            if (s.empty()) return pos <= size() ? pos : npos;
+            if (pos >= size() || s.size() > size() - pos) return npos;
+            ROPE_TRACE_SCOPE(Find, size() * sizeof(CharT));
+            auto runs = segments(pos, size() - s.size() + 1);
+            std::atomic<size_type> best = npos;
+            parallelFor(std::forward<Context>(context), runs.size(), [&](std::size_t i) {
+                auto &run = runs[i];
+                if (run.offset >= best.load(std::memory_order_relaxed)) return;
+                std::basic_string<CharT, Traits, Allocator> window;
+                window.resize(run.length + s.size() - 1);
+                auto at = window.data();
+                visitFrom(run.root, run.skip, window.size(), [&](const CharT *chunk, size_type n) {
+                    at = std::copy_n(chunk, n, at);
+                    return true;
+                });
+                auto hit = window.find(s);
+                if (hit != npos) lower(best, run.offset + hit);
+            });
+            return best.load();
+        }
+        template<ParallelContext Context>
+        auto find(Context &&context, const CharT* s, size_type pos = 0) const -> size_type {
+            if (!s) return npos;
+            return find(std::forward<Context>(context), std::basic_string<CharT, Traits, Allocator>(s), pos);
+        }
+        template<ParallelContext Context>
+        auto find_first_of(Context &&context, const std::basic_string<CharT, Traits, Allocator>& s, size_type pos = 0) const -> size_type {
+            auto runs = segments(pos, size());
+            std::atomic<size_type> best = npos;
+            parallelFor(std::forward<Context>(context), runs.size(), [&](std::size_t i) {
+                auto &run = runs[i];
+                if (run.offset >= best.load(std::memory_order_relaxed)) return;
+                auto at = run.offset;
+                visitFrom(run.root, run.skip, run.length, [&](const CharT *chunk, size_type n) {
+                    for (size_type j = 0; j < n; ++j) {
+                        if (Traits::find(s.data(), s.size(), chunk[j])) {
+                            lower(best, at + j);
+                            return false;
+                        }
+                    }
+                    at += n;
+                    return true;
+                });
+            });
+            return best.load();
+        }
+        template<ParallelContext Context>
+        auto find_first_of(Context &&context, const CharT* s, size_type pos = 0) const -> size_type {
+            if (!s) return npos;
+            return find_first_of(std::forward<Context>(context), std::basic_string<CharT, Traits, Allocator>(s), pos);
+        }
+        template<ParallelContext Context>
+        auto count(Context &&context, CharT ch) const -> size_type {
+            auto runs = segments(0, size());
+            std::vector<size_type> counts(runs.size());
+            parallelFor(std::forward<Context>(context), runs.size(), [&](std::size_t i) {
+                auto &run = runs[i];
+                visitFrom(run.root, run.skip, run.length, [&](const CharT *chunk, size_type n) {
+                    counts[i] += countIn(chunk, n, ch);
+                    return true;
+                });
+            });
+            return std::accumulate(counts.begin(), counts.end(), size_type(0));
+        }
+        template<ParallelContext Context>
+        auto copy(Context &&context, CharT* dest, size_type count, size_type pos = 0) const -> size_type {
+            if (pos >= size()) return 0;
+            count = std::min(count, size() - pos);
+            ROPE_TRACE_SCOPE(Copy, count * sizeof(CharT));
+            auto runs = segments(pos, pos + count);
+            parallelFor(std::forward<Context>(context), runs.size(), [&](std::size_t i) {
+                auto &run = runs[i];
+                auto at = dest + (run.offset - pos);
+                visitFrom(run.root, run.skip, run.length, [&](const CharT *chunk, size_type n) {
+                    at = std::copy_n(chunk, n, at);
+                    return true;
+                });
+            });
+            return count;
+        }
     private:
-        Tree<CharT, Traits, Allocator> tree;
+        // Text of a string of at most small_size characters, kept inside the object: no heap memory at all
+        struct SmallText {
+            std::array<CharT, small_size + 1> data {};
+            size_type size = 0;
+            auto view() const -> std::basic_string_view<CharT, Traits> { return {data.data(), size}; }
+        };
+        std::variant<SmallText, TreeType> storage;
+        [[no_unique_address]] Allocator allocator;
+        // Tree built from the inline text for tree-only readers (iterators, data(), stats()), dropped on every change
+        mutable std::atomic<std::shared_ptr<const TreeType>> mirror;
+        // Flat copy behind view(), valid while its revision matches the tree's
+        struct FlatCopy {
+            StringType text;
+            std::uint64_t revision;
+        };
+        mutable std::atomic<std::shared_ptr<const FlatCopy>> flat_cache;
+
+        auto small() -> SmallText* { return std::get_if<SmallText>(&storage); }
+        auto small() const -> const SmallText* { return std::get_if<SmallText>(&storage); }
+
+        // The tree for writing, a small string moves its text into one first
+        auto rope() -> TreeType& {
+            if (auto text = small()) {
+                storage.template emplace<TreeType>(TreeType::build(std::span<const CharT>(text->data.data(), text->size), allocator));
+                invalidate();
+            }
+            return std::get<TreeType>(storage);
+        }
+        // An iterator at `pos`, over the inline text of a small string so it never depends on the tree image
+        template<typename It>
+        auto iteratorAt(size_type pos) const -> It {
+            if (auto text = small()) return It(text->data.data(), text->size, pos);
+            return It(tree(), pos);
+        }
+        /*
+         * The tree for reading, a small string builds it from its text once per revision like view() does.
+         * Writes through front() and back() change the inline text without dropping the image, so it is
+         * checked against the text (at most small_size characters) and replaced once they no longer match.
+         */
+        auto tree() const -> const TreeType& {
+            if (auto held = std::get_if<TreeType>(&storage)) return *held;
+            auto built = mirror.load(std::memory_order_acquire);
+            auto text = small();
+            if (!built || !mirrors(*built, text->view())) {
+                std::shared_ptr<const TreeType> published = std::allocate_shared<TreeType>(allocator,
+                    TreeType::build(std::span<const CharT>(text->data.data(), text->size), allocator));
+                built = mirror.compare_exchange_strong(built, published, std::memory_order_acq_rel) ? published : built;
+            }
+            return *built;
+        }
+        static auto mirrors(const TreeType &image, std::basic_string_view<CharT, Traits> text) -> bool {
+            for (auto &root : image.getRoots()) {
+                for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) {
+                    std::basic_string_view<CharT, Traits> piece(leaf->str);
+                    if (text.substr(0, piece.size()) != piece) return false;
+                    text.remove_prefix(piece.size());
+                }
+            }
+            return text.empty();
+        }
+        // Drop what was derived from the text. A new tree counts revisions from zero again, so this runs on every switch too
+        void invalidate() {
+            if (flat_cache.load(std::memory_order_relaxed)) flat_cache.store(nullptr, std::memory_order_relaxed);
+            if (mirror.load(std::memory_order_relaxed)) mirror.store(nullptr, std::memory_order_relaxed);
+        }
+        /*
+         * Move a tree of at most `limit` characters back inline. Edits use half of small_size so a string
+         * growing and shrinking around the threshold does not switch on every edit.
+         * Anchors and the journal live in the tree, a tree carrying them stays one.
+         */
+        void settle(size_type limit = small_size / 2) {
+            auto held = std::get_if<TreeType>(&storage);
+            if (!held || held->carriesState()) return;
+            auto total = held->size();
+            if (total > limit) return;
+            SmallText text;
+            visitFrom(0, 0, total, [&](const CharT *chunk, size_type n) {
+                Traits::copy(text.data.data() + text.size, chunk, n);
+                text.size += n;
+                return true;
+            });
+            storage = text;
+            invalidate();
+        }
+        // The inline text, if replacing `count` characters at `index` by `length` new ones leaves it within small_size
+        auto smallFor(size_type index, size_type count, size_type length) -> SmallText* {
+            auto text = small();
+            if (!text) return nullptr;
+            index = std::min(index, text->size);
+            count = std::min(count, text->size - index);
+            return text->size - count + length <= small_size ? text : nullptr;
+        }
+        // Replace [index, index + count) of the inline text by `length` characters written by write(dest), index and count are clamped
+        template<typename Write>
+        void editSmall(SmallText &text, size_type index, size_type count, size_type length, Write &&write) {
+            index = std::min(index, text.size);
+            count = std::min(count, text.size - index);
+            auto data = text.data.data();
+            Traits::move(data + index + length, data + index + count, text.size - index - count);
+            write(data + index);
+            text.size = text.size - count + length;
+            invalidate();
+        }
+        // Whether `text` views the inline buffer, which shifts on edits and goes away on promotion
+        auto viewsSmall(std::basic_string_view<CharT, Traits> text) const -> bool {
+            auto inline_text = small();
+            if (!inline_text) return false;
+            auto data = inline_text->data.data();
+            return std::less_equal<>()(data, text.data()) && std::less<>()(text.data(), data + inline_text->data.size());
+        }
+        // Whether `text` views a leaf taken over by Tree::adopt, which the next edit in front of the end cuts up
+        auto viewsAdopted(std::basic_string_view<CharT, Traits> text) const -> bool {
+            auto rope_tree = std::get_if<TreeType>(&storage);
+            auto single = rope_tree ? rope_tree->contiguous() : nullptr;
+            if (!single || single->size() <= TreeType::max_leaf_size) return false;
+            return std::less_equal<>()(single->data(), text.data()) && std::less<>()(text.data(), single->data() + single->size());
+        }
+        void editSmall(SmallText &text, size_type index, size_type count, std::basic_string_view<CharT, Traits> with) {
+            if (viewsSmall(with)) {
+                // `with` views this very text, which is about to shift
+                std::array<CharT, small_size + 1> copy;
+                Traits::copy(copy.data(), with.data(), with.size());
+                return editSmall(text, index, count, {copy.data(), with.size()});
+            }
+            editSmall(text, index, count, with.size(), [&](CharT *at) { Traits::copy(at, with.data(), with.size()); });
+        }
+
+        // Every text edit goes through these: in place while the string stays small, else on the tree
+        void pushText(std::basic_string_view<CharT, Traits> text) {
+            if (auto inline_text = smallFor(npos, 0, text.size())) {
+                ROPE_TRACE_SCOPE(Push, text.size() * sizeof(CharT));
+                editSmall(*inline_text, npos, 0, text);
+            } else if (viewsSmall(text)) {
+                pushText(StringType(text, allocator));
+            } else {
+                rope().push(text);
+            }
+        }
+        void insertText(size_type index, std::basic_string_view<CharT, Traits> text) {
+            if (auto inline_text = smallFor(index, 0, text.size())) {
+                ROPE_TRACE_SCOPE(Insert, text.size() * sizeof(CharT));
+                editSmall(*inline_text, index, 0, text);
+            } else if (viewsSmall(text) || viewsAdopted(text)) {
+                insertText(index, StringType(text, allocator));
+            } else {
+                rope().insert(index, text);
+            }
+        }
+        void replaceText(size_type index, size_type count, std::basic_string_view<CharT, Traits> text) {
+            if (auto inline_text = smallFor(index, count, text.size())) {
+                ROPE_TRACE_SCOPE(Replace, text.size() * sizeof(CharT));
+                editSmall(*inline_text, index, count, text);
+            } else if (viewsSmall(text) || viewsAdopted(text)) {
+                replaceText(index, count, StringType(text, allocator));
+            } else {
+                rope().replace(index, count, text);
+                settle();
+            }
+        }
+        // Replace the whole text, `text` may view this string itself
+        void assignText(std::basic_string_view<CharT, Traits> text) {
+            auto held = std::get_if<TreeType>(&storage);
+            if (text.size() <= small_size && !(held && held->carriesState())) {
+                ROPE_TRACE_SCOPE(Push, text.size() * sizeof(CharT));
+                SmallText fresh;
+                Traits::copy(fresh.data.data(), text.data(), text.size());
+                fresh.size = text.size();
+                storage = fresh;
+                invalidate();
+                return;
+            }
+            StringType copy(text, allocator);
+            clear();
+            rope().push(copy);
+        }
+        // Input ranges fill the free inline space first and promote with the rest
+        template<typename InputIt, typename Sentinel>
+        void pushRange(InputIt first, Sentinel last) {
+            if (auto text = small()) {
+                [[maybe_unused]] auto readers = mirror.load(std::memory_order_relaxed); // `first` may walk our own tree image
+                while (first != last && text->size < small_size) text->data[text->size++] = *first++;
+                invalidate();
+                if (first == last) return;
+            }
+            rope().push(std::move(first), std::move(last));
+        }
+        // Take the text of `other`. A tree carrying anchors or a journal is assigned to so they see the change
+        void assignFrom(const BasicString &other) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) allocator = other.allocator;
+            auto held = std::get_if<TreeType>(&storage);
+            if (auto text = other.small(); text && !(held && held->carriesState())) storage = *text;
+            else rope() = other.tree();
+            invalidate();
+        }
+        /*
+         * Take the tree of `other` without copying, leaving `other` empty. Its anchors and journal come along,
+         * unless this string carries its own: then the text is assigned to this tree so they see the change.
+         * A tree from an allocator this string may not adopt is copied instead.
+         */
+        void assignFrom(BasicString &&other) noexcept(nothrow_move_assign) {
+            if (this == &other) return;
+            bool foreign = false;
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) allocator = other.allocator;
+            else foreign = allocator != other.allocator;
+            if (other.small() || foreign) assignFrom(std::as_const(other));
+            else if (auto held = std::get_if<TreeType>(&storage); held && held->carriesState()) *held = std::move(std::get<TreeType>(other.storage));
+            else storage.template emplace<TreeType>(std::move(std::get<TreeType>(other.storage)));
+            other.storage.template emplace<SmallText>();
+            invalidate();
+            other.invalidate();
+        }
+        // A loaded tree, moved inline when it is short
+        static auto fromTree(TreeType &&loaded) -> BasicString {
+            BasicString result(loaded.get_allocator());
+            result.storage.template emplace<TreeType>(std::move(loaded));
+            result.settle(small_size);
+            return result;
+        }
+        // Leaf `leaf` filled by read(CharT*, bytes), without zeroing it first where the library allows
+        template<typename Fill>
+        static auto loadLeaf(const SerialLayout &layout, std::size_t leaf, const Allocator &alloc, Fill &&fill) -> StringType {
+            StringType text(alloc);
+            auto count = static_cast<size_type>(layout.leaf_sizes[leaf]);
+#ifdef __cpp_lib_string_resize_and_overwrite
+            text.resize_and_overwrite(count, [&](CharT *data, size_type n) { fill(data, n * sizeof(CharT)); return n; });
+#else
+            text.resize(count);
+            fill(text.data(), count * sizeof(CharT));
+#endif
+            layout.verify(leaf, text.data());
+            return text;
+        }
+        template<typename Read>
+        static auto readSerial(Read &&read, const Allocator &alloc) -> BasicString {
+            auto layout = readSerialLayout<CharT>(read);
+            return fromTree(TreeType::assemble(layout.root_leaves, [&](std::size_t leaf) {
+                return loadLeaf(layout, leaf, alloc, read);
+            }, alloc));
+        }
+        // Header and tables of a mapped image, and its payload checked to hold every character
+        static auto mapSerial(std::span<const std::byte> image) -> std::pair<SerialLayout, std::span<const std::byte>> {
+            std::size_t offset = 0;
+            auto layout = readSerialLayout<CharT>(serialReader(image, offset));
+            auto payload = image.subspan(offset);
+            if (payload.size() / sizeof(CharT) < layout.header.characters) throw std::runtime_error("Rope::deserialize: unexpected end of input");
+            return {std::move(layout), payload};
+        }
+        static auto imageLeaf(const SerialLayout &layout, std::span<const std::byte> payload, std::size_t leaf, const Allocator &alloc) -> StringType {
+            auto from = payload.data() + layout.leaf_offsets[leaf] * sizeof(CharT);
+            return loadLeaf(layout, leaf, alloc, [from](void *data, std::size_t bytes) { if (bytes) std::memcpy(data, from, bytes); });
+        }
+        // Call found(pos) for every occurrence of `pattern` from left to right, without overlaps
+        template<typename Found>
+        void forEachMatch(std::basic_string_view<CharT, Traits> pattern, Found &&found) const {
+            if (pattern.empty()) return;
+            if (auto text = small()) {
+                auto inline_text = text->view();
+                for (auto pos = inline_text.find(pattern); pos != inline_text.npos; pos = inline_text.find(pattern, pos + pattern.size()))
+                    found(pos);
+                return;
+            }
+            // every piece of split() but the last one ends where an occurrence starts
+            auto total = size();
+            for (auto piece : split(pattern))
+                if (auto end = piece.position() + piece.size(); end < total) found(end);
+        }
+        // Apply the occurrences replace_all() found, an inline text is rebuilt as a whole
+        void applyMatches(std::span<const Edit> edits) {
+            if (edits.empty()) return;
+            auto text = small();
+            if (!text) {
+                apply(edits);
+                return;
+            }
+            auto source = text->view();
+            StringType result(allocator);
+            size_type at = 0;
+            for (auto &edit : edits) {
+                result.append(source.substr(at, edit.offset - at)).append(edit.text);
+                at = edit.offset + edit.count;
+            }
+            result.append(source.substr(at));
+            assign(std::move(result));
+        }
+        // Append text the caller gives up: short text is copied inline, longer buffers become leaves as they are
+        void pushOwned(StringType &&str) {
+            if (smallFor(npos, 0, str.size())) pushText(str);
+            else rope().adopt(std::move(str));
+        }
+
+        // A run of roots scanned by one parallel task: `length` characters from `skip` into roots[root]
+        struct Segment {
+            std::size_t root;
+            size_type skip;
+            size_type offset;
+            size_type length;
+        };
+
+        // Split [pos, end) into runs of whole roots of at least parallel_grain characters
+        auto segments(size_type pos, size_type end) const -> std::vector<Segment> {
+            std::vector<Segment> result;
+            auto &roots = tree().getRoots();
+            size_type start = 0;
+            for (std::size_t i = 0; i < roots.size() && start < end; ++i) {
+                auto root_end = start + roots[i].second;
+                if (root_end > pos) {
+                    auto from = std::max(pos, start);
+                    if (result.empty() || result.back().length >= parallel_grain)
+                        result.push_back({i, from - start, from, 0});
+                    result.back().length += std::min(end, root_end) - from;
+                }
+                start = root_end;
+            }
+            return result;
+        }
+
+        // Whether the text equals `text` of the same size
+        auto equals(std::basic_string_view<CharT, Traits> text) const -> bool {
+            if (auto inline_text = small()) return inline_text->view() == text;
+            bool equal = true;
+            visitFrom(0, 0, text.size(), [&](const CharT *chunk, size_type n) {
+                equal = Traits::compare(chunk, text.data(), n) == 0;
+                text.remove_prefix(n);
+                return equal;
+            });
+            return equal;
+        }
+        // Call fn(chunk, n) over `count` characters starting `skip` characters into roots[root], fn returns false to stop
+        template<typename F>
+        void visitFrom(std::size_t root, size_type skip, size_type count, F &&fn) const {
+            auto &roots = tree().getRoots();
+            for (; root < roots.size() && count > 0; ++root) {
+                for (auto leaf = roots[root].first.get(); leaf && count > 0; leaf = leaf->right.get()) {
+                    auto leaf_size = leaf->str.size();
+                    if (skip >= leaf_size) {
+                        skip -= leaf_size;
+                        continue;
+                    }
+                    auto take = std::min(leaf_size - skip, count);
+                    if (!fn(leaf->str.data() + skip, take)) return;
+                    count -= take;
+                    skip = 0;
+                }
+            }
+        }
+
+        static auto countIn(const CharT *chunk, size_type n, CharT ch) -> size_type {
+            return static_cast<size_type>(std::count_if(chunk, chunk + n, [ch](CharT c) { return Traits::eq(c, ch); }));
+        }
+
+        static void lower(std::atomic<size_type> &best, size_type value) {
+            auto current = best.load(std::memory_order_relaxed);
+            while (value < current && !best.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        }
+
+        // Append without a temporary string when `t` already is a view of characters
+        template<typename SV>
+        void pushView(const SV &t) {
+            if constexpr (std::is_convertible_v<const SV&, std::basic_string_view<CharT, Traits>>)
+                pushText(std::basic_string_view<CharT, Traits>(t));
+            else
+                pushText(StringType(t));
+        }
+        template<typename SV>
+        void assignView(const SV &t) {
+            if constexpr (std::is_convertible_v<const SV&, std::basic_string_view<CharT, Traits>>)
+                assignText(std::basic_string_view<CharT, Traits>(t));
+            else
+                assignText(StringType(t));
+        }
+        template<typename SV>
+        void replaceView(size_type pos, size_type count, const SV &t) {
+            if constexpr (std::is_convertible_v<const SV&, std::basic_string_view<CharT, Traits>>)
+                replaceText(pos, count, std::basic_string_view<CharT, Traits>(t));
+            else
+                replaceText(pos, count, StringType(t));
+        }
+
+        static auto bounds(const_iterator first, const_iterator last) -> std::pair<size_type, size_type> {
+            auto b = first.position();
+            auto e = last.position();
+            if (e < b) std::swap(b, e);
+            return {b, e};
+        }
 
         auto getAtPos(size_type pos) const -> CharT& {
-            auto &roots = tree.getRoots();
+            if (auto text = small()) return const_cast<CharT&>(text->data[pos]);
+            auto &roots = tree().getRoots();
             std::size_t offset = 0;
             NodeType *leaf = nullptr;
 
@@ -1175,4 +1896,6 @@ namespace Rope {
         }
     };
 }
+// split() and lines() hand out BasicStringView
+#include <StringView.h>
 #endif //ROPE_BASICSTRING_H
\ No newline at end of file
@@ -0,0 +1,183 @@
+#ifndef ROPE_FORMAT_H
+#define ROPE_FORMAT_H
+
+#include <BasicString.h>
+#include <version>
+#if __has_include(<format>)
+#include <format>
+#endif
+
+#ifdef __cpp_lib_format
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <iterator>
+#include <ostream>
+#include <type_traits>
+
+/*
+ * std::format support: "{}", "{:*^20}", "{:.10}", "{:>{}.{}}" ... with the standard string spec
+ * [[fill]align][width][.precision][s]. The text is written leaf by leaf into the output, a rope is
+ * never flattened. Width and precision count characters (code units), fill is a single character.
+ */
+template<typename CharT, typename Traits, typename Allocator, Rope::SizePolicy Policy>
+struct std::formatter<Rope::BasicString<CharT, Traits, Allocator, Policy>, CharT> {
+    constexpr auto parse(std::basic_format_parse_context<CharT> &ctx) -> typename std::basic_format_parse_context<CharT>::iterator {
+        auto it = ctx.begin(), end = ctx.end();
+        auto is_align = [](CharT ch) { return ch == CharT('<') || ch == CharT('>') || ch == CharT('^'); };
+        if (it != end && std::next(it) != end && is_align(*std::next(it)) && *it != CharT('{') && *it != CharT('}')) {
+            fill = *it;
+            align = static_cast<char>(*std::next(it));
+            it += 2;
+        } else if (it != end && is_align(*it)) {
+            align = static_cast<char>(*it++);
+        }
+        it = parseCount(ctx, it, width);
+        if (it != end && *it == CharT('.')) {
+            auto digits = ++it;
+            it = parseCount(ctx, it, precision);
+            if (it == digits) throw std::format_error("Rope::BasicString: missing precision after '.'");
+        }
+        if (it != end && *it == CharT('s')) ++it;
+        if (it != end && *it != CharT('}')) throw std::format_error("Rope::BasicString: invalid format spec");
+        return it;
+    }
+
+    template<typename FormatContext>
+    auto format(const Rope::BasicString<CharT, Traits, Allocator, Policy> &s, FormatContext &ctx) const -> typename FormatContext::iterator {
+        auto shown = std::min<std::size_t>(s.size(), resolve(ctx, precision, std::size_t(-1)));
+        auto pad = std::max(resolve(ctx, width, 0), shown) - shown;
+        auto before = align == '>' ? pad : align == '^' ? pad / 2 : 0;
+        auto out = std::fill_n(ctx.out(), before, fill);
+        s.for_each_chunk([&](std::basic_string_view<CharT, Traits> chunk) { out = std::copy(chunk.begin(), chunk.end(), out); }, 0, shown);
+        return std::fill_n(out, pad - before, fill);
+    }
+
+private:
+    // A width or precision: absent, a number, or taken from the argument `arg`
+    struct Count {
+        std::size_t value = 0;
+        std::size_t arg = 0;
+        enum { none, number, argument } kind = none;
+    };
+    CharT fill = CharT(' ');
+    char align = 0; // strings align left by default
+    Count width, precision;
+
+    static constexpr auto parseCount(std::basic_format_parse_context<CharT> &ctx, typename std::basic_format_parse_context<CharT>::iterator it, Count &count)
+        -> typename std::basic_format_parse_context<CharT>::iterator {
+        auto end = ctx.end();
+        auto digits = [&](std::size_t &value) {
+            auto start = it;
+            for (value = 0; it != end && *it >= CharT('0') && *it <= CharT('9'); ++it)
+                value = value * 10 + static_cast<std::size_t>(*it - CharT('0'));
+            return it != start;
+        };
+        if (it != end && *it == CharT('{')) {
+            ++it;
+            if (digits(count.arg)) ctx.check_arg_id(count.arg);
+            else count.arg = ctx.next_arg_id();
+            if (it == end || *it != CharT('}')) throw std::format_error("Rope::BasicString: invalid dynamic width or precision");
+            count.kind = Count::argument;
+            return ++it;
+        }
+        if (digits(count.value)) count.kind = Count::number;
+        return it;
+    }
+    template<typename FormatContext>
+    static auto resolve(FormatContext &ctx, const Count &count, std::size_t otherwise) -> std::size_t {
+        if (count.kind == Count::none) return otherwise;
+        if (count.kind == Count::number) return count.value;
+        return std::visit_format_arg([](auto value) -> std::size_t {
+            using T = decltype(value);
+            if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, CharT> && !std::is_same_v<T, char>) {
+                if constexpr (std::is_signed_v<T>) if (value < 0) throw std::format_error("Rope::BasicString: negative width or precision");
+                return static_cast<std::size_t>(value);
+            } else {
+                throw std::format_error("Rope::BasicString: width or precision is not an integer");
+            }
+        }, ctx.arg(count.arg));
+    }
+};
+
+namespace Rope {
+    /*
+     * Output iterator into a FILE*, so std::format_to never builds a std::string first. std::format_to
+     * hands the characters over one at a time, they are gathered in a Block and written with fwrite
+     * a block at a time, taking the stream lock once per block instead of once per character.
+     */
+    class FileWriter {
+    public:
+        class Block {
+        public:
+            explicit Block(std::FILE *file) : file(file) {}
+            Block(const Block&) = delete;
+            auto operator=(const Block&) -> Block& = delete;
+            void put(char ch) {
+                if (used == data.size()) flush();
+                data[used++] = ch;
+            }
+            void flush() {
+                std::fwrite(data.data(), sizeof(char), used, file);
+                used = 0;
+            }
+        private:
+            std::FILE *file;
+            std::array<char, 4096> data;
+            std::size_t used = 0;
+        };
+
+        using iterator_category = std::output_iterator_tag;
+        using value_type = void;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = void;
+
+        FileWriter() = default;
+        explicit FileWriter(Block &block) : block(&block) {}
+        auto operator=(char ch) -> FileWriter& {
+            block->put(ch);
+            return *this;
+        }
+        auto operator*() -> FileWriter& { return *this; }
+        auto operator++() -> FileWriter& { return *this; }
+        auto operator++(int) -> FileWriter { return *this; }
+    private:
+        Block *block = nullptr;
+    };
+
+    /*
+     * Like std::print / std::println, but formatting directly into the stream: a rope argument is
+     * written leaf by leaf and no formatted string is allocated. No Unicode transcoding is done.
+     */
+    template<typename... Args>
+    void print(std::FILE *stream, std::format_string<Args...> fmt, Args&&... args) {
+        FileWriter::Block block(stream);
+        std::format_to(FileWriter(block), fmt, std::forward<Args>(args)...);
+        block.flush();
+    }
+    template<typename... Args>
+    void print(std::format_string<Args...> fmt, Args&&... args) {
+        Rope::print(stdout, fmt, std::forward<Args>(args)...);
+    }
+    template<typename... Args>
+    void print(std::ostream &os, std::format_string<Args...> fmt, Args&&... args) {
+        std::format_to(std::ostreambuf_iterator<char>(os), fmt, std::forward<Args>(args)...);
+    }
+    template<typename... Args>
+    void println(std::FILE *stream, std::format_string<Args...> fmt, Args&&... args) {
+        Rope::print(stream, fmt, std::forward<Args>(args)...);
+        std::fputc('\n', stream);
+    }
+    template<typename... Args>
+    void println(std::format_string<Args...> fmt, Args&&... args) {
+        Rope::println(stdout, fmt, std::forward<Args>(args)...);
+    }
+    template<typename... Args>
+    void println(std::ostream &os, std::format_string<Args...> fmt, Args&&... args) {
+        Rope::print(os, fmt, std::forward<Args>(args)...);
+        os.put('\n');
+    }
+}
+#endif
+#endif //ROPE_FORMAT_H
@@ -0,0 +1,121 @@
+#ifndef ROPE_JOURNAL_H
+#define ROPE_JOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+namespace Rope {
+    /*
+     * One edit: at `offset`, `removed` characters were replaced by `inserted` characters.
+     * Offsets are in the coordinates of the text right before the edit.
+     */
+    struct Change {
+        std::size_t offset = 0;
+        std::size_t removed = 0;
+        std::size_t inserted = 0;
+
+        auto operator==(const Change &other) const -> bool = default;
+    };
+
+    /*
+     * Opt-in record of the edits made to a Tree.
+     * Consumers subscribe with a cursor and pull what changed since their last pull,
+     * changes nobody is subscribed to are not kept.
+     */
+    class Journal {
+    public:
+        class Cursor {
+            std::shared_ptr<std::uint64_t> position;
+            friend class Journal;
+        public:
+            auto valid() const -> bool { return static_cast<bool>(position); }
+        };
+
+        void record(std::size_t offset, std::size_t removed, std::size_t inserted) {
+            if (removed == 0 && inserted == 0) return;
+            if (!subscribed()) {
+                base += changes.size() + 1;
+                changes.clear();
+                return;
+            }
+            changes.push_back({offset, removed, inserted});
+        }
+        auto subscribe() -> Cursor {
+            Cursor cursor;
+            cursor.position = std::make_shared<std::uint64_t>(base + changes.size());
+            cursors.push_back(cursor.position);
+            return cursor;
+        }
+        // Number of raw changes recorded after the cursor
+        auto pending(const Cursor &cursor) const -> std::size_t {
+            return base + changes.size() - *cursor.position;
+        }
+        // Raw changes recorded after the cursor, in order, advancing it
+        auto read(Cursor &cursor) -> std::vector<Change> {
+            auto from = changes.begin() + static_cast<std::ptrdiff_t>(*cursor.position - base);
+            std::vector<Change> result(from, changes.end());
+            *cursor.position = base + changes.size();
+            trim();
+            return result;
+        }
+        /*
+         * Changes after the cursor merged into sorted, disjoint ranges in current coordinates:
+         * [offset, offset + inserted) is new text that replaced `removed` old characters.
+         */
+        auto pull(Cursor &cursor) -> std::vector<Change> {
+            std::vector<Change> dirty;
+            for (auto &change : read(cursor))
+                coalesce(dirty, change);
+            return dirty;
+        }
+
+        static void coalesce(std::vector<Change> &dirty, const Change &change) {
+            auto edit_end = change.offset + change.removed;
+            auto first = std::find_if(dirty.begin(), dirty.end(), [&](const Change &range) {
+                return range.offset + range.inserted >= change.offset;
+            });
+            auto last = std::find_if(first, dirty.end(), [&](const Change &range) {
+                return range.offset > edit_end;
+            });
+
+            Change merged = change;
+            if (first != last) {
+                // Text between the touched ranges was unchanged so far, it counts as both old and new
+                auto start = std::min(change.offset, first->offset);
+                auto end = std::max(edit_end, std::prev(last)->offset + std::prev(last)->inserted);
+                std::size_t old_length = end - start;
+                for (auto it = first; it != last; ++it)
+                    old_length = old_length - it->inserted + it->removed;
+                merged = {start, old_length, end - start - change.removed + change.inserted};
+            }
+            for (auto it = last; it != dirty.end(); ++it)
+                it->offset = it->offset + change.inserted - change.removed;
+            auto at = dirty.erase(first, last);
+            dirty.insert(at, merged);
+        }
+
+    private:
+        std::deque<Change> changes;
+        std::uint64_t base = 0; // sequence number of changes.front()
+        std::vector<std::weak_ptr<std::uint64_t>> cursors;
+
+        auto subscribed() -> bool {
+            std::erase_if(cursors, [](auto &weak) { return weak.expired(); });
+            return !cursors.empty();
+        }
+        // Drop the changes every live cursor has already read
+        void trim() {
+            if (!subscribed()) return;
+            auto lowest = base + changes.size();
+            for (auto &weak : cursors)
+                lowest = std::min(lowest, *weak.lock());
+            changes.erase(changes.begin(), changes.begin() + static_cast<std::ptrdiff_t>(lowest - base));
+            base = lowest;
+        }
+    };
+}
+#endif //ROPE_JOURNAL_H
@@ -4,11 +4,8 @@
 #include <vector>
 #include <string>
 #include <memory>
-#ifndef ROPE_STRING_MAX_LEAF_SIZE
-#define ROPE_STRING_MAX_LEAF_SIZE 128
-#endif
+#include <Policy.h>
 namespace Rope {
-    constexpr std::size_t max_leaf_size = ROPE_STRING_MAX_LEAF_SIZE;
     template<typename CharT, typename Traits = std::char_traits<CharT>, typename Allocator = std::allocator<CharT>>
     struct Node : std::enable_shared_from_this<Node<CharT, Traits, Allocator>> {
         using StringType = std::basic_string<CharT, Traits, Allocator>;
@@ -19,7 +16,11 @@ namespace Rope {
         Node *top = nullptr;
         bool ending_node = false; // when a next node is new root
         Node() = default;
+        explicit Node(Allocator allocator) : str(allocator) {}
         Node(const std::basic_string<CharT, Traits, Allocator> &str, Allocator allocator) : str(str, allocator) {}
+        // takes the buffer over when its allocator compares equal, copies it otherwise
+        Node(std::basic_string<CharT, Traits, Allocator> &&str, Allocator allocator) : str(std::move(str), allocator) {}
+        Node(const CharT *data, std::size_t count, Allocator allocator) : str(data, count, allocator) {}
 
         auto size() const -> std::size_t {
             std::size_t size = str.size();
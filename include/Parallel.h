@@ -0,0 +1,81 @@
+#ifndef ROPE_PARALLEL_H
+#define ROPE_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <execution>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Rope {
+    // Characters handed to one parallel task, small enough to balance and large enough to amortize scheduling
+    constexpr std::size_t parallel_grain = std::size_t(1) << 18;
+
+    /*
+     * Executor: anything callable as exec(count, task) that runs task(0) ... task(count - 1),
+     * possibly concurrently, and returns once all of them finished.
+     */
+    template<typename E>
+    concept Executor = requires(E &exec, std::size_t count, const std::function<void(std::size_t)> &task) {
+        exec(count, task);
+    };
+
+    template<typename P>
+    concept ExecutionPolicy = std::is_execution_policy_v<std::remove_cvref_t<P>>;
+
+    // Parallel rope algorithms accept a standard execution policy or an Executor
+    template<typename P>
+    concept ParallelContext = ExecutionPolicy<P> || Executor<std::remove_cvref_t<P>>;
+
+    /*
+     * Minimal pool-less executor: spawns up to `threads` workers that pull task indices from a shared counter.
+     * Use it where the standard library runs parallel policies serially (libstdc++ without TBB).
+     */
+    class ThreadExecutor {
+        unsigned threads;
+    public:
+        explicit ThreadExecutor(unsigned threads = std::thread::hardware_concurrency()) : threads(std::max(1u, threads)) {}
+
+        void operator()(std::size_t count, const std::function<void(std::size_t)> &task) const {
+            std::atomic<std::size_t> next = 0;
+            std::exception_ptr error;
+            std::mutex error_mutex;
+            auto work = [&] {
+                for (auto i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                    try {
+                        task(i);
+                    } catch (...) {
+                        std::lock_guard lock(error_mutex);
+                        if (!error) error = std::current_exception();
+                    }
+                }
+            };
+            std::vector<std::jthread> workers;
+            auto spawn = std::min<std::size_t>(threads, count) - (count > 0);
+            for (std::size_t i = 0; i < spawn; ++i)
+                workers.emplace_back(work);
+            work();
+            workers.clear();
+            if (error) std::rethrow_exception(error);
+        }
+    };
+
+    // Run task(i) for every i in [0, count) on the given policy or executor
+    template<ParallelContext Context, typename Task>
+    void parallelFor(Context &&context, std::size_t count, Task &&task) {
+        if constexpr (ExecutionPolicy<Context>) {
+            std::vector<std::size_t> indices(count);
+            std::iota(indices.begin(), indices.end(), std::size_t(0));
+            std::for_each(std::forward<Context>(context), indices.begin(), indices.end(), task);
+        } else {
+            context(count, std::function<void(std::size_t)>(task));
+        }
+    }
+}
+#endif //ROPE_PARALLEL_H
@@ -0,0 +1,56 @@
+#ifndef ROPE_POLICY_H
+#define ROPE_POLICY_H
+
+#include <concepts>
+#include <cstddef>
+
+/*
+ * Deprecated fallback: ROPE_STRING_MAX_LEAF_SIZE / ROPE_STRING_MAX_ROOT_SIZE / ROPE_STRING_SMALL_SIZE change
+ * Rope::DefaultChunks, the policy of Rope::String and the other aliases. They must be defined the same way in every
+ * translation unit of a program (on the compiler command line, never before an #include), otherwise the same
+ * Rope::String names different layouts (an ODR violation). Prefer an explicit Rope::ChunkPolicy.
+ */
+#ifndef ROPE_STRING_MAX_LEAF_SIZE
+#define ROPE_STRING_MAX_LEAF_SIZE 128
+#endif
+#ifndef ROPE_STRING_MAX_ROOT_SIZE
+#define ROPE_STRING_MAX_ROOT_SIZE 512
+#endif
+#ifndef ROPE_STRING_SMALL_SIZE
+#define ROPE_STRING_SMALL_SIZE 32
+#endif
+static_assert(ROPE_STRING_MAX_LEAF_SIZE > 0 && ROPE_STRING_MAX_ROOT_SIZE >= ROPE_STRING_MAX_LEAF_SIZE,
+              "ROPE_STRING_MAX_ROOT_SIZE must be at least ROPE_STRING_MAX_LEAF_SIZE, and both positive");
+namespace Rope {
+    /*
+     * Chunk sizes of a rope, the last template parameter of Tree and BasicString.
+     * leaf_size: characters per leaf, root_size: characters per root (a chain of root_size / leaf_size leaves).
+     * small_size: strings up to this length are kept inline by BasicString, without a tree or any allocation.
+     * Small chunks make edits cheap, large chunks make scans, indexing and memory cheap.
+     */
+    template<typename P>
+    concept SizePolicy = requires {
+        { P::leaf_size } -> std::convertible_to<std::size_t>;
+        { P::root_size } -> std::convertible_to<std::size_t>;
+        { P::small_size } -> std::convertible_to<std::size_t>;
+    } && (P::leaf_size > 0 && P::root_size >= P::leaf_size);
+
+    // small_size defaults to ROPE_STRING_SMALL_SIZE, capped at one leaf; 0 turns the inline mode off
+    template<std::size_t LeafSize, std::size_t RootSize, std::size_t SmallSize = (LeafSize < ROPE_STRING_SMALL_SIZE ? LeafSize : ROPE_STRING_SMALL_SIZE)>
+    struct ChunkPolicy {
+        static constexpr std::size_t leaf_size = LeafSize;
+        static constexpr std::size_t root_size = RootSize;
+        static constexpr std::size_t small_size = SmallSize;
+    };
+
+    // used by Rope::String and friends, 128/512 unless the deprecated macros above say otherwise
+    using DefaultChunks = ChunkPolicy<ROPE_STRING_MAX_LEAF_SIZE, ROPE_STRING_MAX_ROOT_SIZE>;
+    // Tuned presets, see bench/rope_autotune.cpp to pick sizes for a workload
+    using SmallChunks = ChunkPolicy<32, 256>;     // keystroke editing of small documents
+    using MediumChunks = ChunkPolicy<128, 2048>;  // mixed editing and searching
+    using LargeChunks = ChunkPolicy<1024, 16384>; // large documents, bulk loads, scans and random access
+
+    constexpr std::size_t max_leaf_size = DefaultChunks::leaf_size;
+    constexpr std::size_t max_root_size = DefaultChunks::root_size;
+}
+#endif //ROPE_POLICY_H
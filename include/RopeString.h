@@ -3,7 +3,13 @@
 #include <Node.h>
 #include <Tree.h>
 #include <BasicString.h>
+#include <StringView.h>
+#include <SharedString.h>
+#include <Appender.h>
+#include <Format.h>
+#include <Stream.h>
 #include <cstdlib>
+#include <memory_resource>
 
 namespace Rope {
     using String   = BasicString<char>;     // Standard 8-bit string
@@ -11,6 +17,31 @@ namespace Rope {
     using U8String = BasicString<char8_t>;  // UTF-8 (C++20+)
     using U16String= BasicString<char16_t>; // UTF-16
     using U32String= BasicString<char32_t>; // UTF-32
+
+    using StringView   = BasicStringView<char>; // read-only range of a String, valid until the String changes
+    using WStringView  = BasicStringView<wchar_t>;
+    using U8StringView = BasicStringView<char8_t>;
+    using U16StringView= BasicStringView<char16_t>;
+    using U32StringView= BasicStringView<char32_t>;
+
+    using SharedString = BasicSharedString<char>; // single writer, snapshot readers
+    using Appender = BasicAppender<char>;         // many threads appending to one String
+
+    using RopeBuf = BasicRopeBuf<char>;           // std::streambuf reading and appending to a String
+    using IRopeStream = BasicIRopeStream<char>;
+    using ORopeStream = BasicORopeStream<char>;
+
+    // Ropes whose leaves, nodes and root lists all come from a std::pmr::memory_resource
+    namespace pmr {
+        template<typename CharT, typename Traits = std::char_traits<CharT>, SizePolicy Policy = DefaultChunks>
+        using BasicString = Rope::BasicString<CharT, Traits, std::pmr::polymorphic_allocator<CharT>, Policy>;
+
+        using String   = BasicString<char>;
+        using WString  = BasicString<wchar_t>;
+        using U8String = BasicString<char8_t>;
+        using U16String= BasicString<char16_t>;
+        using U32String= BasicString<char32_t>;
+    }
 }
 
 
@@ -0,0 +1,219 @@
+#ifndef ROPE_SERIALIZE_H
+#define ROPE_SERIALIZE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#if __has_include(<unistd.h>)
+#include <cerrno>
+#include <unistd.h>
+#define ROPE_SERIAL_FD 1
+#endif
+
+namespace Rope {
+    /*
+     * Binary format of a saved rope, keeping its chunk layout so loading neither walks nor re-chunks text:
+     *
+     *   SerialHeader                         64 bytes
+     *   leaves per root                      std::uint64_t[roots]
+     *   characters per leaf                  std::uint64_t[leaves]
+     *   checksum per leaf                    std::uint32_t[leaves], only with SerialFlags::checksums
+     *   zero padding up to payload_offset    a multiple of serial_alignment
+     *   payload                              the leaves back to back, characters * char_size bytes
+     *
+     * Empty leaves and roots are not stored, so every leaf holds at least one character.
+     * Every field is in the byte order of the writer, a reader of the other order rejects the file.
+     * Offsets of a leaf in the payload follow from the leaf table, so a mapped file can be read at any leaf.
+     */
+    struct SerialHeader {
+        std::array<char, 4> magic {'R', 'O', 'P', 'E'};
+        std::uint16_t version = 1;
+        std::uint16_t byte_order = 0x0102;
+        std::uint8_t char_size = 0;
+        std::uint8_t flags = 0;
+        std::uint16_t reserved = 0;
+        std::uint32_t leaf_size = 0; // chunk sizes of the writer, for information
+        std::uint64_t root_size = 0;
+        std::uint64_t characters = 0;
+        std::uint64_t roots = 0;
+        std::uint64_t leaves = 0;
+        std::uint64_t payload_offset = 0;
+        std::uint64_t reserved2 = 0;
+    };
+    static_assert(sizeof(SerialHeader) == 64 && std::is_trivially_copyable_v<SerialHeader>);
+
+    namespace SerialFlags {
+        constexpr std::uint8_t checksums = 1;
+    }
+    constexpr std::size_t serial_alignment = 64;
+
+    struct SerializeOptions {
+        bool checksums = false; // store a checksum per leaf, verified on load
+    };
+
+    // FNV-1a over the bytes of one leaf
+    inline auto serialChecksum(const void *data, std::size_t bytes) -> std::uint32_t {
+        auto p = static_cast<const unsigned char*>(data);
+        std::uint32_t hash = 2166136261u;
+        for (std::size_t i = 0; i < bytes; ++i) hash = (hash ^ p[i]) * 16777619u;
+        return hash;
+    }
+
+    /*
+     * Write `tree` through write(const void*, bytes). The tables are written first and then the
+     * leaves one by one, so the text is never materialized.
+     */
+    template<typename TreeType, typename Write>
+    void writeSerial(const TreeType &tree, Write &&write, SerializeOptions options = {}) {
+        using CharT = typename TreeType::value_type;
+        SerialHeader header;
+        header.char_size = sizeof(CharT);
+        header.flags = options.checksums ? SerialFlags::checksums : 0;
+        header.leaf_size = static_cast<std::uint32_t>(TreeType::max_leaf_size);
+        header.root_size = TreeType::max_root_size;
+        header.characters = tree.size();
+
+        std::vector<std::uint64_t> root_leaves, leaf_sizes;
+        std::vector<std::uint32_t> checksums;
+        for (auto &root : tree.getRoots()) {
+            std::uint64_t count = 0;
+            for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) {
+                if (leaf->str.empty()) continue;
+                leaf_sizes.push_back(leaf->str.size());
+                if (options.checksums) checksums.push_back(serialChecksum(leaf->str.data(), leaf->str.size() * sizeof(CharT)));
+                ++count;
+            }
+            if (count) root_leaves.push_back(count);
+        }
+        header.roots = root_leaves.size();
+        header.leaves = leaf_sizes.size();
+        auto tables = sizeof(header) + (root_leaves.size() + leaf_sizes.size()) * sizeof(std::uint64_t) + checksums.size() * sizeof(std::uint32_t);
+        header.payload_offset = (tables + serial_alignment - 1) / serial_alignment * serial_alignment;
+
+        write(&header, sizeof(header));
+        write(root_leaves.data(), root_leaves.size() * sizeof(std::uint64_t));
+        write(leaf_sizes.data(), leaf_sizes.size() * sizeof(std::uint64_t));
+        write(checksums.data(), checksums.size() * sizeof(std::uint32_t));
+        std::array<char, serial_alignment> padding {};
+        write(padding.data(), header.payload_offset - tables);
+        for (auto &root : tree.getRoots())
+            for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get())
+                write(leaf->str.data(), leaf->str.size() * sizeof(CharT));
+    }
+
+    // Header and tables of a saved rope, read and checked before any leaf
+    struct SerialLayout {
+        SerialHeader header;
+        std::vector<std::uint64_t> root_leaves;
+        std::vector<std::uint64_t> leaf_sizes;
+        std::vector<std::uint32_t> checksums;
+        std::vector<std::uint64_t> leaf_offsets; // in characters from the start of the payload
+
+        // Throws std::runtime_error unless the leaf matches its stored checksum
+        void verify(std::size_t leaf, const void *data) const {
+            if (checksums.empty()) return;
+            if (serialChecksum(data, leaf_sizes[leaf] * header.char_size) != checksums[leaf])
+                throw std::runtime_error("Rope::deserialize: checksum mismatch in leaf " + std::to_string(leaf));
+        }
+    };
+
+    // Read and validate everything up to the payload through read(void*, bytes)
+    template<typename CharT, typename Read>
+    auto readSerialLayout(Read &&read) -> SerialLayout {
+        SerialLayout layout;
+        auto &header = layout.header;
+        read(&header, sizeof(header));
+        if (header.magic != SerialHeader().magic) throw std::runtime_error("Rope::deserialize: not a serialized rope");
+        if (header.version != 1) throw std::runtime_error("Rope::deserialize: unsupported version " + std::to_string(header.version));
+        if (header.byte_order != 0x0102) throw std::runtime_error("Rope::deserialize: written with another byte order");
+        if (header.char_size != sizeof(CharT)) throw std::runtime_error("Rope::deserialize: written with another character size");
+        // every leaf holds a character, which bounds the tables before allocating them
+        if (header.leaves > header.characters || header.roots > header.leaves || (header.roots == 0) != (header.leaves == 0))
+            throw std::runtime_error("Rope::deserialize: corrupt tables");
+
+        layout.root_leaves.resize(header.roots);
+        layout.leaf_sizes.resize(header.leaves);
+        read(layout.root_leaves.data(), layout.root_leaves.size() * sizeof(std::uint64_t));
+        read(layout.leaf_sizes.data(), layout.leaf_sizes.size() * sizeof(std::uint64_t));
+        if (header.flags & SerialFlags::checksums) {
+            layout.checksums.resize(header.leaves);
+            read(layout.checksums.data(), layout.checksums.size() * sizeof(std::uint32_t));
+        }
+
+        std::uint64_t leaves = 0, characters = 0;
+        for (auto count : layout.root_leaves) {
+            if (count == 0 || count > header.leaves - leaves) throw std::runtime_error("Rope::deserialize: corrupt tables");
+            leaves += count;
+        }
+        layout.leaf_offsets.reserve(header.leaves);
+        for (auto size : layout.leaf_sizes) {
+            if (size == 0 || size > header.characters - characters) throw std::runtime_error("Rope::deserialize: corrupt tables");
+            layout.leaf_offsets.push_back(characters);
+            characters += size;
+        }
+        auto tables = sizeof(header) + (header.roots + header.leaves) * sizeof(std::uint64_t) + layout.checksums.size() * sizeof(std::uint32_t);
+        if (leaves != header.leaves || characters != header.characters || header.payload_offset < tables || header.payload_offset - tables >= serial_alignment)
+            throw std::runtime_error("Rope::deserialize: corrupt tables");
+
+        std::array<char, serial_alignment> padding;
+        read(padding.data(), header.payload_offset - tables);
+        return layout;
+    }
+
+    // Byte sinks and sources for writeSerial / readSerialLayout, all of them throw on failure
+    inline auto serialWriter(std::ostream &out) {
+        return [&out](const void *data, std::size_t bytes) {
+            if (!out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes)))
+                throw std::runtime_error("Rope::serialize: write failed");
+        };
+    }
+    inline auto serialReader(std::istream &in) {
+        return [&in](void *data, std::size_t bytes) {
+            if (!in.read(static_cast<char*>(data), static_cast<std::streamsize>(bytes)))
+                throw std::runtime_error("Rope::deserialize: unexpected end of input");
+        };
+    }
+    // Reads the image front to back, for the header and tables of a mapped file
+    inline auto serialReader(std::span<const std::byte> image, std::size_t &offset) {
+        return [image, &offset](void *data, std::size_t bytes) {
+            if (bytes > image.size() - offset) throw std::runtime_error("Rope::deserialize: unexpected end of input");
+            if (bytes) std::memcpy(data, image.data() + offset, bytes);
+            offset += bytes;
+        };
+    }
+#ifdef ROPE_SERIAL_FD
+    inline auto serialWriter(int fd) {
+        return [fd](const void *data, std::size_t bytes) {
+            auto p = static_cast<const char*>(data);
+            while (bytes > 0) {
+                auto written = ::write(fd, p, bytes);
+                if (written < 0 && errno == EINTR) continue;
+                if (written <= 0) throw std::runtime_error("Rope::serialize: write failed");
+                p += written;
+                bytes -= static_cast<std::size_t>(written);
+            }
+        };
+    }
+    inline auto serialReader(int fd) {
+        return [fd](void *data, std::size_t bytes) {
+            auto p = static_cast<char*>(data);
+            while (bytes > 0) {
+                auto got = ::read(fd, p, bytes);
+                if (got < 0 && errno == EINTR) continue;
+                if (got <= 0) throw std::runtime_error("Rope::deserialize: unexpected end of input");
+                p += got;
+                bytes -= static_cast<std::size_t>(got);
+            }
+        };
+    }
+#endif
+}
+#endif //ROPE_SERIALIZE_H
@@ -0,0 +1,118 @@
+#ifndef ROPE_SHAREDSTRING_H
+#define ROPE_SHAREDSTRING_H
+#include <BasicString.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Rope {
+    /*
+     * Single writer, many readers. The writer edits its own string and publish()es immutable versions.
+     * A version shares every root with the writer's string, the writer clones a root before writing
+     * into it (Tree::detach), so publishing never copies text.
+     *
+     * Readers register once and then enter the latest version with an epoch store and a pointer load,
+     * they never wait for the writer. Replaced versions are freed by the writer once no reader
+     * that entered before the replacement is still inside.
+     */
+    template<typename CharT, typename Traits = std::char_traits<CharT>, typename Allocator = std::allocator<CharT>, SizePolicy Policy = DefaultChunks>
+    class BasicSharedString {
+        using StringType = BasicString<CharT, Traits, Allocator, Policy>;
+        static constexpr std::uint64_t idle = std::numeric_limits<std::uint64_t>::max();
+
+        struct Slot {
+            std::atomic<std::uint64_t> epoch {idle};
+            bool taken = false;
+        };
+
+        StringType current;                                                               // writer only
+        std::unique_ptr<const StringType> live;                                           // writer only
+        std::vector<std::pair<std::unique_ptr<const StringType>, std::uint64_t>> retired; // writer only
+        std::atomic<const StringType*> published {nullptr};
+        std::atomic<std::uint64_t> epoch {0};
+        std::deque<Slot> slots;
+        std::mutex slots_mutex; // registration and the writer's scan, never taken by a read
+
+        void reclaim() {
+            std::uint64_t oldest = idle;
+            {
+                std::lock_guard lock(slots_mutex);
+                for (auto &slot : slots)
+                    if (slot.taken) oldest = std::min(oldest, slot.epoch.load(std::memory_order_seq_cst));
+            }
+            std::erase_if(retired, [oldest](auto &version) { return version.second < oldest; });
+        }
+
+    public:
+        class ReadGuard {
+            Slot *slot;
+            const StringType *version;
+        public:
+            ReadGuard(Slot *slot, const StringType *version) : slot(slot), version(version) {}
+            ReadGuard(const ReadGuard&) = delete;
+            auto operator=(const ReadGuard&) -> ReadGuard& = delete;
+            ~ReadGuard() { slot->epoch.store(idle, std::memory_order_release); }
+
+            auto operator*() const -> const StringType& { return *version; }
+            auto operator->() const -> const StringType* { return version; }
+        };
+
+        // Per-thread reading handle, at most one ReadGuard of a Reader may be alive at a time
+        class Reader {
+            BasicSharedString *owner;
+            Slot *slot;
+        public:
+            explicit Reader(BasicSharedString &shared) : owner(&shared) {
+                std::lock_guard lock(owner->slots_mutex);
+                auto free = std::find_if(owner->slots.begin(), owner->slots.end(), [](Slot &s) { return !s.taken; });
+                slot = free != owner->slots.end() ? &*free : &owner->slots.emplace_back();
+                slot->taken = true;
+            }
+            Reader(const Reader&) = delete;
+            auto operator=(const Reader&) -> Reader& = delete;
+            ~Reader() {
+                std::lock_guard lock(owner->slots_mutex);
+                slot->epoch.store(idle, std::memory_order_relaxed);
+                slot->taken = false;
+            }
+
+            // Enter the latest published version
+            auto read() const -> ReadGuard {
+                slot->epoch.store(owner->epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+                return ReadGuard(slot, owner->published.load(std::memory_order_seq_cst));
+            }
+            // Owned copy of the latest version that stays valid after leaving it, costs one refcount per root
+            auto snapshot() const -> StringType {
+                auto guard = read();
+                return *guard;
+            }
+        };
+
+        explicit BasicSharedString(StringType initial = StringType()) : current(std::move(initial)) {
+            publish();
+        }
+        BasicSharedString(const BasicSharedString&) = delete;
+        auto operator=(const BasicSharedString&) -> BasicSharedString& = delete;
+
+        auto reader() -> Reader { return Reader(*this); }
+
+        // The writer's working copy, edits become visible to readers on publish()
+        auto writer() -> StringType& { return current; }
+
+        // Make the writer's current state the version new reads enter, and free unreachable old versions
+        void publish() {
+            auto next = std::make_unique<const StringType>(current);
+            published.store(next.get(), std::memory_order_seq_cst);
+            if (live) retired.emplace_back(std::move(live), epoch.fetch_add(1, std::memory_order_seq_cst));
+            live = std::move(next);
+            reclaim();
+        }
+        // Versions replaced but still possibly in use by a reader
+        auto pending() const -> std::size_t { return retired.size(); }
+    };
+}
+#endif //ROPE_SHAREDSTRING_H
@@ -0,0 +1,82 @@
+#ifndef ROPE_SIZE_INDEX_H
+#define ROPE_SIZE_INDEX_H
+
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Rope {
+    /*
+     * Prefix sums over the root sizes of a tree, kept as a Fenwick tree: where a root starts, which root holds
+     * a position, changing the size of one root and appending a root all take O(log n) for n roots.
+     */
+    template<typename Allocator = std::allocator<std::size_t>>
+    class SizeIndex {
+        std::vector<std::size_t, Allocator> sums; // sums[i - 1] covers the sizes of roots [i - low(i), i)
+        std::size_t total_ = 0;
+
+        static auto low(std::size_t i) -> std::size_t { return i & (~i + 1); }
+    public:
+        explicit SizeIndex(const Allocator &allocator = Allocator()) : sums(allocator) {}
+
+        // Rebuild from the (head, size) pairs of `roots` in O(n)
+        template<typename Roots>
+        void assign(const Roots &roots) {
+            sums.resize(roots.size());
+            total_ = 0;
+            for (std::size_t i = 0; i < roots.size(); ++i) {
+                sums[i] = roots[i].second;
+                total_ += roots[i].second;
+            }
+            for (std::size_t i = 1; i <= sums.size(); ++i)
+                if (auto parent = i + low(i); parent <= sums.size()) sums[parent - 1] += sums[i - 1];
+        }
+        // A root of `size` characters behind the last one
+        void push(std::size_t size) {
+            auto i = sums.size() + 1;
+            auto sum = size;
+            for (auto j = i - 1; j > i - low(i); j -= low(j)) sum += sums[j - 1];
+            sums.push_back(sum);
+            total_ += size;
+        }
+        void grow(std::size_t root, std::size_t n) {
+            for (auto i = root + 1; i <= sums.size(); i += low(i)) sums[i - 1] += n;
+            total_ += n;
+        }
+        void shrink(std::size_t root, std::size_t n) {
+            for (auto i = root + 1; i <= sums.size(); i += low(i)) sums[i - 1] -= n;
+            total_ -= n;
+        }
+        // Characters in the roots before `root`
+        auto start(std::size_t root) const -> std::size_t {
+            std::size_t sum = 0;
+            for (auto i = root; i > 0; i -= low(i)) sum += sums[i - 1];
+            return sum;
+        }
+        // The first root ending past `index` and the offset in it, the last root for positions at or past the end
+        auto find(std::size_t index) const -> std::pair<std::size_t, std::size_t> {
+            if (index >= total_) {
+                auto last = sums.size() - 1;
+                return {last, index - start(last)};
+            }
+            std::size_t root = 0;
+            for (auto step = std::bit_floor(sums.size()); step; step >>= 1) {
+                if (root + step <= sums.size() && sums[root + step - 1] <= index) {
+                    root += step;
+                    index -= sums[root - 1];
+                }
+            }
+            return {root, index};
+        }
+        auto total() const -> std::size_t { return total_; }
+
+        void swap(SizeIndex &other) noexcept {
+            using std::swap;
+            swap(sums, other.sums);
+            swap(total_, other.total_);
+        }
+    };
+}
+#endif //ROPE_SIZE_INDEX_H
@@ -0,0 +1,215 @@
+#ifndef ROPE_STREAM_H
+#define ROPE_STREAM_H
+#include <BasicString.h>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace Rope {
+    /*
+     * std::basic_streambuf over a rope, so iostreams read and write it without a std::stringstream in between.
+     *
+     * Writing appends: the put area is a buffer of one leaf, a full buffer is linked into the tree as a leaf
+     * without copying it, and sync() appends a partial one. Reading walks the leaves: the get area is the
+     * current leaf itself and underflow() moves on to the next one, so reads copy nothing either;
+     * pbackfail() steps back into the previous leaf, so unget() and putback() cross leaves too.
+     *
+     * Output reaches the string on overflow, sync() (flush) and destruction. Like an iterator, the get area
+     * views the string's leaves: edits of the string other than through this buffer invalidate it until
+     * the next seek.
+     */
+    template<typename CharT, typename Traits = std::char_traits<CharT>, typename Allocator = std::allocator<CharT>, SizePolicy Policy = DefaultChunks>
+    class BasicRopeBuf : public std::basic_streambuf<CharT, Traits> {
+        using StringType = BasicString<CharT, Traits, Allocator, Policy>;
+        using BufferType = std::basic_string<CharT, Traits, Allocator>;
+        using NodeType = Node<CharT, Traits, Allocator>;
+        using TreeType = Tree<CharT, Traits, Allocator, Policy>;
+    public:
+        using int_type = typename Traits::int_type;
+        using pos_type = typename Traits::pos_type;
+        using off_type = typename Traits::off_type;
+
+        // Reads from and appends to `rope`, as `mode` allows
+        explicit BasicRopeBuf(StringType &rope, std::ios_base::openmode mode = std::ios_base::in | std::ios_base::out)
+            : source(mode & std::ios_base::in ? &rope : nullptr), target(mode & std::ios_base::out ? &rope : nullptr) {}
+        // Reads only
+        explicit BasicRopeBuf(const StringType &rope) : source(&rope) {}
+        BasicRopeBuf(const BasicRopeBuf&) = delete;
+        auto operator=(const BasicRopeBuf&) -> BasicRopeBuf& = delete;
+        ~BasicRopeBuf() override { flushPut(); }
+
+    protected:
+        auto overflow(int_type ch = Traits::eof()) -> int_type override {
+            if (!target) return Traits::eof();
+            if (this->pptr() == this->epptr() && this->pbase()) {
+                // a full leaf: its buffer becomes part of the tree as it is
+                target->append(std::move(put));
+                dropGet();
+            } else {
+                flushPut();
+            }
+            put = BufferType(target->get_allocator());
+            put.resize(StringType::max_leaf_size);
+            this->setp(put.data(), put.data() + put.size());
+            if (Traits::eq_int_type(ch, Traits::eof())) return Traits::not_eof(ch);
+            *this->pptr() = Traits::to_char_type(ch);
+            this->pbump(1);
+            return ch;
+        }
+        auto sync() -> int override {
+            flushPut();
+            return 0;
+        }
+
+        auto underflow() -> int_type override {
+            if (!source) return Traits::eof();
+            if (this->gptr() && this->gptr() < this->egptr()) return Traits::to_int_type(*this->gptr());
+            auto &tree = source->data();
+            if (!leaf || &tree != viewed || tree.revision() != revision) {
+                locate(readPosition());
+            } else {
+                position = leaf_start += leaf->str.size();
+                leaf = nextLeaf(leaf->right.get());
+            }
+            if (!leaf) {
+                position = source->size();
+                this->setg(nullptr, nullptr, nullptr);
+                return Traits::eof();
+            }
+            showLeaf();
+            return Traits::to_int_type(*this->gptr());
+        }
+        // Putting back past the start of the get area: it moves to the leaf holding the previous character.
+        // The source is read only, so only that same character or eof can be put back
+        auto pbackfail(int_type ch = Traits::eof()) -> int_type override {
+            auto at = readPosition();
+            if (!source || at == 0) return Traits::eof();
+            locate(at - 1);
+            if (!leaf) return Traits::eof();
+            showLeaf();
+            if (!Traits::eq_int_type(ch, Traits::eof()) && !Traits::eq(Traits::to_char_type(ch), *this->gptr())) {
+                this->gbump(1);
+                return Traits::eof();
+            }
+            return Traits::not_eof(ch);
+        }
+        auto showmanyc() -> std::streamsize override {
+            if (!source) return -1;
+            auto left = source->size() - std::min(source->size(), readPosition());
+            return left ? static_cast<std::streamsize>(left) : -1;
+        }
+
+        // Reading seeks anywhere in the string, writing only reports its position (tellp)
+        auto seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) -> pos_type override {
+            if (which & std::ios_base::in) {
+                if (!source) return pos_type(off_type(-1));
+                auto size = static_cast<off_type>(source->size());
+                auto from = dir == std::ios_base::beg ? 0 : dir == std::ios_base::cur ? static_cast<off_type>(readPosition()) : size;
+                auto to = from + off;
+                if (to < 0 || to > size) return pos_type(off_type(-1));
+                dropGet();
+                position = static_cast<std::size_t>(to);
+                return pos_type(to);
+            }
+            if ((which & std::ios_base::out) && target && off == 0 && dir != std::ios_base::beg)
+                return pos_type(static_cast<off_type>(target->size() + pending()));
+            return pos_type(off_type(-1));
+        }
+        auto seekpos(pos_type pos, std::ios_base::openmode which) -> pos_type override {
+            return seekoff(off_type(pos), std::ios_base::beg, which);
+        }
+
+    private:
+        const StringType *source = nullptr;
+        StringType *target = nullptr;
+        BufferType put;
+        // read cursor: `leaf` starts at offset `leaf_start` of the tree `viewed` at revision `revision`
+        const TreeType *viewed = nullptr;
+        std::uint64_t revision = 0;
+        const NodeType *leaf = nullptr;
+        std::size_t root = 0;
+        std::size_t leaf_start = 0;
+        std::size_t position = 0; // read position while there is no get area
+
+        auto pending() const -> std::size_t {
+            return static_cast<std::size_t>(this->pptr() - this->pbase());
+        }
+        void flushPut() {
+            if (!target || pending() == 0) return;
+            target->append(this->pbase(), pending());
+            this->setp(put.data(), put.data() + put.size());
+            dropGet();
+        }
+        auto readPosition() const -> std::size_t {
+            return this->gptr() ? leaf_start + static_cast<std::size_t>(this->gptr() - this->eback()) : position;
+        }
+        // Writes may have moved the leaves the get area views, the next read finds its place again
+        void dropGet() {
+            position = readPosition();
+            this->setg(nullptr, nullptr, nullptr);
+            leaf = nullptr;
+        }
+        // First non-empty leaf from `next` on, continuing with the following roots
+        auto nextLeaf(const NodeType *next) -> const NodeType* {
+            auto &roots = viewed->getRoots();
+            while (true) {
+                for (; next; next = next->right.get())
+                    if (!next->str.empty()) return next;
+                if (++root >= roots.size()) return nullptr;
+                next = roots[root].first.get();
+            }
+        }
+        // The get area over `leaf`, from the read position on
+        void showLeaf() {
+            auto data = const_cast<CharT*>(leaf->str.data());
+            this->setg(data, data + (position - leaf_start), data + leaf->str.size());
+        }
+        void locate(std::size_t at) {
+            viewed = &source->data();
+            revision = viewed->revision();
+            position = at;
+            leaf = nullptr;
+            leaf_start = 0;
+            auto &roots = viewed->getRoots();
+            for (root = 0; root < roots.size() && leaf_start + roots[root].second <= at; ++root)
+                leaf_start += roots[root].second;
+            if (root >= roots.size()) return;
+            for (auto node = roots[root].first.get(); node; node = node->right.get()) {
+                if (at < leaf_start + node->str.size()) {
+                    leaf = node;
+                    return;
+                }
+                leaf_start += node->str.size();
+            }
+        }
+    };
+
+    // std::basic_istream reading a rope through a BasicRopeBuf
+    template<typename CharT, typename Traits = std::char_traits<CharT>, typename Allocator = std::allocator<CharT>, SizePolicy Policy = DefaultChunks>
+    class BasicIRopeStream : public std::basic_istream<CharT, Traits> {
+        using StringType = BasicString<CharT, Traits, Allocator, Policy>;
+        using BufType = BasicRopeBuf<CharT, Traits, Allocator, Policy>;
+        BufType buf;
+    public:
+        explicit BasicIRopeStream(const StringType &rope) : std::basic_istream<CharT, Traits>(nullptr), buf(rope) {
+            this->init(&buf);
+        }
+        auto rdbuf() const -> BufType* { return const_cast<BufType*>(&buf); }
+    };
+
+    // std::basic_ostream appending to a rope through a BasicRopeBuf, flushed on destruction
+    template<typename CharT, typename Traits = std::char_traits<CharT>, typename Allocator = std::allocator<CharT>, SizePolicy Policy = DefaultChunks>
+    class BasicORopeStream : public std::basic_ostream<CharT, Traits> {
+        using StringType = BasicString<CharT, Traits, Allocator, Policy>;
+        using BufType = BasicRopeBuf<CharT, Traits, Allocator, Policy>;
+        BufType buf;
+    public:
+        explicit BasicORopeStream(StringType &rope) : std::basic_ostream<CharT, Traits>(nullptr), buf(rope, std::ios_base::out) {
+            this->init(&buf);
+        }
+        auto rdbuf() const -> BufType* { return const_cast<BufType*>(&buf); }
+    };
+}
+#endif //ROPE_STREAM_H
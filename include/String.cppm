@@ -8,4 +8,38 @@ export namespace Rope {
     using Rope::U8String;
     using Rope::U16String;
     using Rope::U32String;
-}
\ No newline at end of file
+    using Rope::StringView;
+    using Rope::WStringView;
+    using Rope::U8StringView;
+    using Rope::U16StringView;
+    using Rope::U32StringView;
+    using Rope::SharedString;
+    using Rope::Appender;
+    using Rope::AppendOrder;
+    using Rope::ThreadExecutor;
+    using Rope::Executor;
+    using Rope::ParallelContext;
+    using Rope::SerializeOptions;
+    using Rope::RopeBuf;
+    using Rope::IRopeStream;
+    using Rope::ORopeStream;
+#ifdef __cpp_lib_format
+    using Rope::print;
+    using Rope::println;
+#endif
+}
+export namespace Rope::pmr {
+    using Rope::pmr::String;
+    using Rope::pmr::WString;
+    using Rope::pmr::U8String;
+    using Rope::pmr::U16String;
+    using Rope::pmr::U32String;
+}
+export namespace Rope::trace {
+    using Rope::trace::Op;
+    using Rope::trace::Counters;
+    using Rope::trace::Sink;
+    using Rope::trace::Registry;
+    using Rope::trace::registry;
+    using Rope::trace::name;
+}
@@ -0,0 +1,511 @@
+#ifndef ROPE_STRINGVIEW_H
+#define ROPE_STRINGVIEW_H
+#include <BasicString.h>
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace Rope {
+    /*
+     * Non-owning view of [pos, pos + count) of a rope: the tree, the leaf the range starts in and a length.
+     * Scans, copies and comparisons start at that leaf and walk the leaves in place, so passing a range to
+     * a reader neither copies it like substr() nor makes the reader look the position up again.
+     *
+     * Like an iterator the view reads the string's tree and is valid until the next change of the string.
+     */
+    template<typename CharT, typename Traits = std::char_traits<CharT>, typename Allocator = std::allocator<CharT>, SizePolicy Policy = DefaultChunks>
+    class BasicStringView {
+        using StringType = BasicString<CharT, Traits, Allocator, Policy>;
+        using TreeType = Tree<CharT, Traits, Allocator, Policy>;
+        using NodeType = Node<CharT, Traits, Allocator>;
+        using ViewType = std::basic_string_view<CharT, Traits>;
+    public:
+        using traits_type = Traits;
+        using value_type = CharT;
+        using size_type = typename StringType::size_type;
+        using const_iterator = typename StringType::const_iterator;
+        static constexpr auto npos = StringType::npos;
+
+        // Pieces of a range in order, each viewing one leaf in place; next() is empty at the end
+        class Cursor {
+        public:
+            Cursor() = default;
+            Cursor(const TreeType *tree, std::size_t root, const NodeType *leaf, size_type offset, size_type left)
+                : tree(tree), root(root), leaf(leaf), offset(offset), left(left) {}
+            auto next() -> ViewType {
+                while (left > 0 && leaf) {
+                    auto n = std::min(leaf->str.size() - offset, left);
+                    ViewType piece(leaf->str.data() + offset, n);
+                    offset = 0;
+                    advance();
+                    if (n == 0) continue;
+                    left -= n;
+                    return piece;
+                }
+                return {};
+            }
+            // The piece next() returns, without moving on
+            auto peek() const -> ViewType {
+                if (left == 0 || !leaf) return {};
+                return ViewType(leaf->str.data() + offset, std::min(leaf->str.size() - offset, left));
+            }
+            // Step over `count` characters, whole leaves at a time
+            void skip(size_type count) {
+                count = std::min(count, left);
+                while (count > 0 && leaf) {
+                    auto n = leaf->str.size() - offset;
+                    if (count < n) {
+                        offset += count;
+                        left -= count;
+                        return;
+                    }
+                    count -= n;
+                    left -= n;
+                    offset = 0;
+                    advance();
+                }
+                // rest on the leaf holding the next character
+                while (left > 0 && leaf && leaf->str.empty()) advance();
+            }
+            auto remaining() const -> size_type { return left; }
+        private:
+            friend class BasicStringView;
+            const TreeType *tree = nullptr;
+            std::size_t root = 0;
+            const NodeType *leaf = nullptr;
+            size_type offset = 0;
+            size_type left = 0;
+
+            void advance() {
+                if (leaf->right) {
+                    leaf = leaf->right.get();
+                    return;
+                }
+                auto &roots = tree->getRoots();
+                leaf = ++root < roots.size() ? roots[root].first.get() : nullptr;
+            }
+        };
+
+        BasicStringView() = default;
+        // View [pos, pos + count) of `str`, count is clamped to the end. Throws std::out_of_range if pos > size()
+        BasicStringView(const StringType &str, size_type pos = 0, size_type count = npos) : tree_(&str.data()) {
+            auto total = str.size();
+            if (pos > total) throw std::out_of_range("Rope::BasicStringView");
+            start_ = pos;
+            length_ = std::min(count, total - pos);
+            locate();
+        }
+
+        auto size() const -> size_type { return length_; }
+        auto length() const -> size_type { return length_; }
+        auto empty() const -> bool { return length_ == 0; }
+        // Offset of the view in the string it was taken from
+        auto position() const -> size_type { return start_; }
+
+        auto operator[](size_type pos) const -> CharT {
+            auto chunks = cursor();
+            chunks.skip(pos);
+            return chunks.next().front();
+        }
+        auto at(size_type pos) const -> CharT {
+            if (pos >= length_) throw std::out_of_range("Rope::BasicStringView::at");
+            return (*this)[pos];
+        }
+        auto front() const -> CharT {
+            if (empty()) throw std::out_of_range("Rope::BasicStringView::front");
+            return leaf->str[offset];
+        }
+        auto back() const -> CharT {
+            if (empty()) throw std::out_of_range("Rope::BasicStringView::back");
+            return (*this)[length_ - 1];
+        }
+
+        auto begin() const -> const_iterator { return const_iterator(*tree_, start_); }
+        auto end() const -> const_iterator { return const_iterator(*tree_, start_ + length_); }
+        auto cbegin() const -> const_iterator { return begin(); }
+        auto cend() const -> const_iterator { return end(); }
+
+        // Pieces of the whole view, see Cursor
+        auto cursor() const -> Cursor { return Cursor(tree_, root, leaf, offset, length_); }
+        // Call fn(view) for the pieces of [pos, pos + count) in order, each viewing one leaf in place
+        template<typename F>
+        auto for_each_chunk(F &&fn, size_type pos = 0, size_type count = npos) const -> void {
+            if (pos >= length_) return;
+            auto chunks = cursor();
+            chunks.skip(pos);
+            for (auto left = std::min(count, length_ - pos); left > 0;) {
+                auto piece = chunks.next().substr(0, left);
+                fn(piece);
+                left -= piece.size();
+            }
+        }
+        // The range as one std::basic_string_view when it lies within a single leaf, no copy is made
+        auto contiguous() const -> std::optional<ViewType> {
+            if (empty()) return ViewType();
+            if (offset + length_ <= leaf->str.size()) return ViewType(leaf->str.data() + offset, length_);
+            return std::nullopt;
+        }
+        auto copy(CharT *dest, size_type count, size_type pos = 0) const -> size_type {
+            if (pos > length_) throw std::out_of_range("Rope::BasicStringView::copy");
+            size_type written = 0;
+            for_each_chunk([&](ViewType piece) {
+                Traits::copy(dest + written, piece.data(), piece.size());
+                written += piece.size();
+            }, pos, count);
+            return written;
+        }
+        auto to_string() const -> std::basic_string<CharT, Traits, Allocator> {
+            std::basic_string<CharT, Traits, Allocator> result(length_, CharT(), tree_ ? tree_->get_allocator() : Allocator());
+            copy(result.data(), length_);
+            return result;
+        }
+        // [pos, pos + count) of this view, found by walking from its first leaf
+        auto substr(size_type pos = 0, size_type count = npos) const -> BasicStringView {
+            if (pos > length_) throw std::out_of_range("Rope::BasicStringView::substr");
+            auto result = *this;
+            result.start_ += pos;
+            result.length_ = std::min(count, length_ - pos);
+            result.skipTo(pos);
+            return result;
+        }
+
+        auto find(CharT ch, size_type pos = 0) const -> size_type {
+            return scan(pos, [ch](ViewType piece) { return piece.find(ch); });
+        }
+        // Matches may cross leaves: the last needle length - 1 characters of the text before a leaf are kept and searched together with its start
+        auto find(ViewType needle, size_type pos = 0) const -> size_type {
+            if (needle.size() <= 1) return needle.empty() ? (pos <= length_ ? pos : npos) : find(needle.front(), pos);
+            if (pos >= length_ || needle.size() > length_ - pos) return npos;
+            ROPE_TRACE_SCOPE(Find, (length_ - pos) * sizeof(CharT));
+            auto keep = needle.size() - 1;
+            std::basic_string<CharT, Traits> carry, window;
+            auto at = pos;
+            auto found = npos;
+            auto chunks = cursor();
+            chunks.skip(pos);
+            for (auto piece = chunks.next(); !piece.empty(); piece = chunks.next()) {
+                if (!carry.empty()) {
+                    window.assign(carry).append(piece.substr(0, keep));
+                    if (auto hit = window.find(needle); hit != npos) {
+                        found = at - carry.size() + hit;
+                        break;
+                    }
+                }
+                if (auto hit = piece.find(needle); hit != npos) {
+                    found = at + hit;
+                    break;
+                }
+                if (piece.size() >= keep) {
+                    carry.assign(piece.substr(piece.size() - keep));
+                } else {
+                    carry.append(piece);
+                    if (carry.size() > keep) carry.erase(0, carry.size() - keep);
+                }
+                at += piece.size();
+            }
+            return found;
+        }
+        auto rfind(CharT ch, size_type pos = npos) const -> size_type {
+            auto last = npos;
+            size_type at = 0;
+            for_each_chunk([&](ViewType piece) {
+                if (auto hit = piece.rfind(ch); hit != npos) last = at + hit;
+                at += piece.size();
+            }, 0, pos == npos ? npos : pos + 1);
+            return last;
+        }
+        // Repeated find() over the rest of the view, each one starting at the leaf of the previous match
+        auto rfind(ViewType needle, size_type pos = npos) const -> size_type {
+            if (needle.size() > length_) return npos;
+            auto last = npos;
+            auto rest = substr(0, std::min(pos, length_ - needle.size()) + needle.size());
+            size_type base = 0;
+            for (auto hit = rest.find(needle); hit != npos; hit = rest.find(needle)) {
+                last = base + hit;
+                if (hit == rest.length_) break;
+                rest = rest.substr(hit + 1);
+                base += hit + 1;
+            }
+            return last;
+        }
+        auto find_first_of(ViewType set, size_type pos = 0) const -> size_type {
+            return scan(pos, [set](ViewType piece) { return piece.find_first_of(set); });
+        }
+        auto find_first_not_of(ViewType set, size_type pos = 0) const -> size_type {
+            return scan(pos, [set](ViewType piece) { return piece.find_first_not_of(set); });
+        }
+        auto count(CharT ch) const -> size_type {
+            size_type result = 0;
+            for_each_chunk([&](ViewType piece) {
+                result += static_cast<size_type>(std::count_if(piece.begin(), piece.end(), [ch](CharT c) { return Traits::eq(c, ch); }));
+            });
+            return result;
+        }
+
+        auto compare(ViewType other) const -> int {
+            size_type at = 0;
+            int result = 0;
+            auto chunks = cursor();
+            for (auto piece = chunks.next(); !piece.empty() && result == 0 && at < other.size(); piece = chunks.next()) {
+                auto n = std::min(piece.size(), other.size() - at);
+                result = Traits::compare(piece.data(), other.data() + at, n);
+                if (result == 0 && n < piece.size()) return 1;
+                at += n;
+            }
+            if (result != 0) return result < 0 ? -1 : 1;
+            return length_ < other.size() ? -1 : length_ > other.size() ? 1 : 0;
+        }
+        // Both ranges are walked leaf by leaf side by side
+        auto compare(const BasicStringView &other) const -> int {
+            auto mine = cursor(), theirs = other.cursor();
+            ViewType a, b;
+            while (true) {
+                if (a.empty()) a = mine.next();
+                if (b.empty()) b = theirs.next();
+                if (a.empty() || b.empty()) break;
+                auto n = std::min(a.size(), b.size());
+                if (auto result = Traits::compare(a.data(), b.data(), n)) return result < 0 ? -1 : 1;
+                a.remove_prefix(n);
+                b.remove_prefix(n);
+            }
+            return length_ < other.length_ ? -1 : length_ > other.length_ ? 1 : 0;
+        }
+        auto operator==(ViewType other) const -> bool {
+            return length_ == other.size() && compare(other) == 0;
+        }
+        auto operator==(const BasicStringView &other) const -> bool {
+            return length_ == other.length_ && compare(other) == 0;
+        }
+
+        auto starts_with(ViewType prefix) const -> bool {
+            return prefix.size() <= length_ && substr(0, prefix.size()) == prefix;
+        }
+        auto starts_with(CharT ch) const -> bool {
+            return !empty() && Traits::eq(front(), ch);
+        }
+        auto ends_with(ViewType suffix) const -> bool {
+            return suffix.size() <= length_ && substr(length_ - suffix.size()) == suffix;
+        }
+        auto ends_with(CharT ch) const -> bool {
+            return !empty() && Traits::eq(back(), ch);
+        }
+        auto contains(ViewType needle) const -> bool {
+            return find(needle) != npos;
+        }
+        auto contains(CharT ch) const -> bool {
+            return find(ch) != npos;
+        }
+
+        // Lazy ranges of the pieces between delimiters, see BasicSplitView
+        auto split(CharT delim) const -> BasicSplitView<CharT, Traits, Allocator, Policy> {
+            return {*this, BasicSplitView<CharT, Traits, Allocator, Policy>::Mode::Char, ViewType(&delim, 1)};
+        }
+        auto split(ViewType delim) const -> BasicSplitView<CharT, Traits, Allocator, Policy> {
+            using Split = BasicSplitView<CharT, Traits, Allocator, Policy>;
+            return {*this, delim.size() == 1 ? Split::Mode::Char : Split::Mode::String, delim};
+        }
+        auto split_any(ViewType set) const -> BasicSplitView<CharT, Traits, Allocator, Policy> {
+            return {*this, BasicSplitView<CharT, Traits, Allocator, Policy>::Mode::Any, set};
+        }
+        auto lines() const -> BasicSplitView<CharT, Traits, Allocator, Policy> {
+            CharT newline('\n');
+            return {*this, BasicSplitView<CharT, Traits, Allocator, Policy>::Mode::Lines, ViewType(&newline, 1)};
+        }
+
+    private:
+        friend class BasicSplitView<CharT, Traits, Allocator, Policy>;
+        const TreeType *tree_ = nullptr;
+        size_type start_ = 0;
+        size_type length_ = 0;
+        // where the view starts: `offset` characters into `leaf`, a leaf of roots[root]
+        std::size_t root = 0;
+        const NodeType *leaf = nullptr;
+        size_type offset = 0;
+
+        // A piece starting where `at` rests, for the split ranges
+        BasicStringView(const TreeType *tree, size_type start, size_type length, const Cursor &at)
+            : tree_(tree), start_(start), length_(length), root(at.root), leaf(length ? at.leaf : nullptr), offset(at.offset) {}
+
+        // Find the leaf holding the first character, once per view: the root through the tree's size index, then the leaves of one root
+        void locate() {
+            if (length_ == 0) return;
+            auto [first, local] = tree_->locateRoot(start_);
+            root = first;
+            for (leaf = tree_->getRoots()[root].first.get(); local >= leaf->str.size(); leaf = leaf->right.get()) local -= leaf->str.size();
+            offset = local;
+        }
+        // Move the start `pos` characters on from the current one
+        void skipTo(size_type pos) {
+            if (length_ == 0) {
+                leaf = nullptr;
+                return;
+            }
+            Cursor chunks(tree_, root, leaf, offset, pos + length_);
+            chunks.skip(pos);
+            root = chunks.root;
+            leaf = chunks.leaf;
+            offset = chunks.offset;
+        }
+        // First match of find_in(piece) at or after pos
+        template<typename FindIn>
+        auto scan(size_type pos, FindIn &&find_in) const -> size_type {
+            if (pos >= length_) return npos;
+            ROPE_TRACE_SCOPE(Find, (length_ - pos) * sizeof(CharT));
+            auto at = pos;
+            auto chunks = cursor();
+            chunks.skip(pos);
+            for (auto piece = chunks.next(); !piece.empty(); piece = chunks.next()) {
+                if (auto hit = find_in(piece); hit != ViewType::npos) return at + hit;
+                at += piece.size();
+            }
+            return npos;
+        }
+    };
+
+    /*
+     * Lazy range of the pieces of a BasicStringView between delimiters: a character, a string, any character
+     * of a set, or line ends for lines(). Each piece is a BasicStringView, contiguous() hands it out as a
+     * std::basic_string_view when it lies within one leaf.
+     *
+     * The iterator keeps its place in the leaves, so walking the range scans every leaf once with
+     * std::char_traits::find (memchr for char) and allocates nothing. Like std::views::split, a delimiter at the
+     * end is followed by an empty piece and an empty source has no pieces. lines() drops a '\r' before each '\n'
+     * and has no empty piece after a final line end. An empty delimiter string never matches.
+     */
+    template<typename CharT, typename Traits, typename Allocator, SizePolicy Policy>
+    class BasicSplitView : public std::ranges::view_interface<BasicSplitView<CharT, Traits, Allocator, Policy>> {
+        using ViewType = std::basic_string_view<CharT, Traits>;
+        using PieceType = BasicStringView<CharT, Traits, Allocator, Policy>;
+        using Cursor = typename PieceType::Cursor;
+        using size_type = typename PieceType::size_type;
+    public:
+        enum class Mode { Char, String, Any, Lines };
+
+        BasicSplitView(const PieceType &source, Mode mode, ViewType delim) : source(source), mode(mode), delim(delim) {}
+
+        class iterator {
+        public:
+            using value_type = PieceType;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::forward_iterator_tag;
+
+            iterator() = default;
+            // by value: a forward iterator must not hand out references into itself
+            auto operator*() const -> PieceType { return piece; }
+            auto operator++() -> iterator& {
+                advance();
+                return *this;
+            }
+            auto operator++(int) -> iterator {
+                auto tmp = *this;
+                advance();
+                return tmp;
+            }
+            auto operator==(const iterator &other) const -> bool {
+                return done == other.done && (done || at == other.at);
+            }
+            auto operator==(std::default_sentinel_t) const -> bool { return done; }
+
+        private:
+            friend class BasicSplitView;
+            const BasicSplitView *range = nullptr;
+            Cursor rest;        // from the start of the next piece to the end of the source
+            size_type at = 0;   // offset of `rest` in the source
+            PieceType piece;
+            bool done = true;
+            bool trailing = false; // an empty piece after a delimiter at the very end is still due
+
+            explicit iterator(const BasicSplitView *range) : range(range), rest(range->source.cursor()), done(false) {
+                if (rest.remaining() == 0) done = true;
+                else advance();
+            }
+            void advance() {
+                if (rest.remaining() == 0) {
+                    if (trailing) {
+                        piece = PieceType(range->source.tree_, range->source.start_ + at, 0, rest);
+                        trailing = false;
+                    } else {
+                        done = true;
+                    }
+                    return;
+                }
+                auto start = rest;
+                auto [length, skip] = range->next(rest);
+                piece = PieceType(range->source.tree_, range->source.start_ + at, length, start);
+                at += skip;
+                trailing = skip > length && rest.remaining() == 0 && range->mode != Mode::Lines;
+            }
+        };
+
+        auto begin() const -> iterator { return iterator(this); }
+        auto end() const -> std::default_sentinel_t { return {}; }
+
+    private:
+        PieceType source;
+        Mode mode;
+        std::basic_string<CharT, Traits> delim; // the delimiter, the set or the line end; short ones stay in the string object
+
+        struct Match {
+            size_type length;
+            size_type skip;
+        };
+        // The next piece from `rest` on: its length and the characters up to the start of the piece after it, `rest` moves there
+        auto next(Cursor &rest) const -> Match {
+            auto scan = rest;
+            size_type distance = 0;
+            CharT before {};
+            auto found = [&](size_type hit, size_type length, size_type width) -> Match {
+                scan.skip(hit + width);
+                rest = scan;
+                return {distance + length, distance + hit + width};
+            };
+            for (auto part = scan.peek(); !part.empty(); part = scan.peek()) {
+                switch (mode) {
+                    case Mode::Char:
+                        if (auto hit = part.find(delim.front()); hit != ViewType::npos) return found(hit, hit, 1);
+                        break;
+                    case Mode::Any:
+                        if (auto hit = part.find_first_of(delim); hit != ViewType::npos) return found(hit, hit, 1);
+                        break;
+                    case Mode::Lines:
+                        if (auto hit = part.find(delim.front()); hit != ViewType::npos) {
+                            auto last = hit ? part[hit - 1] : before;
+                            auto cr = (hit || distance) && Traits::eq(last, CharT('\r'));
+                            return found(hit, hit - cr, 1);
+                        }
+                        break;
+                    case Mode::String:
+                        if (delim.empty()) break;
+                        for (auto hit = part.find(delim.front()); hit != ViewType::npos; hit = part.find(delim.front(), hit + 1)) {
+                            auto after = scan;
+                            after.skip(part.size());
+                            if (matchesAt(part.substr(hit), after)) return found(hit, hit, delim.size());
+                        }
+                        break;
+                }
+                before = part.back();
+                distance += part.size();
+                scan.skip(part.size());
+            }
+            rest = scan;
+            return {distance, distance};
+        }
+        // Whether the delimiter starts `part`, reading on through `after` where it crosses into the next leaves
+        auto matchesAt(ViewType part, Cursor after) const -> bool {
+            ViewType want = delim;
+            while (!want.empty()) {
+                if (part.empty() && (part = after.next()).empty()) return false;
+                auto n = std::min(want.size(), part.size());
+                if (Traits::compare(want.data(), part.data(), n) != 0) return false;
+                want.remove_prefix(n);
+                part.remove_prefix(n);
+            }
+            return true;
+        }
+    };
+}
+#endif //ROPE_STRINGVIEW_H
@@ -0,0 +1,119 @@
+#ifndef ROPE_TRACE_H
+#define ROPE_TRACE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/*
+ * Operation tracing. Define ROPE_STRING_TRACE before including the library to count calls, bytes and
+ * latencies of rope operations; without it the ROPE_TRACE_* macros expand to nothing and cost nothing.
+ */
+namespace Rope::trace {
+    enum class Op : std::size_t {
+        Push,
+        Insert,
+        Erase,
+        Replace,
+        Apply,
+        Find,
+        Copy,
+        CStr,
+        Flatten,   // a whole-string copy made to fall back on std::basic_string, a hidden O(n)
+        LeafAlloc, // a leaf node allocated, counted without latency
+        Count
+    };
+    constexpr std::size_t op_count = static_cast<std::size_t>(Op::Count);
+
+    constexpr auto name(Op op) -> std::string_view {
+        constexpr std::array<std::string_view, op_count> names {
+            "push", "insert", "erase", "replace", "apply", "find", "copy", "c_str", "flatten", "leaf_alloc"
+        };
+        return names[static_cast<std::size_t>(op)];
+    }
+
+    // Latencies in power of two nanosecond buckets: bucket i holds [2^(i-1), 2^i) ns
+    constexpr std::size_t histogram_buckets = 40;
+
+    struct Counters {
+        std::uint64_t calls = 0;
+        std::uint64_t bytes = 0;
+        std::array<std::uint64_t, histogram_buckets> latency {};
+    };
+
+    // Called for every traced operation, from the thread that ran it
+    using Sink = void (*)(Op op, std::size_t bytes, std::uint64_t nanoseconds);
+
+    class Registry {
+        struct Slot {
+            std::atomic<std::uint64_t> calls {0};
+            std::atomic<std::uint64_t> bytes {0};
+            std::array<std::atomic<std::uint64_t>, histogram_buckets> latency {};
+        };
+        std::array<Slot, op_count> slots;
+        std::atomic<Sink> sink {nullptr};
+    public:
+        void record(Op op, std::size_t bytes, std::uint64_t nanoseconds, bool timed = true) {
+            auto &slot = slots[static_cast<std::size_t>(op)];
+            slot.calls.fetch_add(1, std::memory_order_relaxed);
+            slot.bytes.fetch_add(bytes, std::memory_order_relaxed);
+            if (timed) {
+                auto bucket = std::min<std::size_t>(histogram_buckets - 1, std::bit_width(nanoseconds));
+                slot.latency[bucket].fetch_add(1, std::memory_order_relaxed);
+            }
+            if (auto export_to = sink.load(std::memory_order_acquire)) export_to(op, bytes, nanoseconds);
+        }
+        auto counters(Op op) const -> Counters {
+            auto &slot = slots[static_cast<std::size_t>(op)];
+            Counters result;
+            result.calls = slot.calls.load(std::memory_order_relaxed);
+            result.bytes = slot.bytes.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < histogram_buckets; ++i)
+                result.latency[i] = slot.latency[i].load(std::memory_order_relaxed);
+            return result;
+        }
+        void reset() {
+            for (auto &slot : slots) {
+                slot.calls.store(0, std::memory_order_relaxed);
+                slot.bytes.store(0, std::memory_order_relaxed);
+                for (auto &bucket : slot.latency) bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+        void setSink(Sink export_to) { sink.store(export_to, std::memory_order_release); }
+    };
+
+    inline auto registry() -> Registry& {
+        static Registry instance;
+        return instance;
+    }
+
+    // Times the enclosing block and records it on exit
+    class Scope {
+        Op op;
+        std::size_t bytes;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    public:
+        Scope(Op op, std::size_t bytes) : op(op), bytes(bytes) {}
+        Scope(const Scope&) = delete;
+        auto operator=(const Scope&) -> Scope& = delete;
+        ~Scope() {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            registry().record(op, bytes, static_cast<std::uint64_t>(elapsed.count()));
+        }
+    };
+}
+
+#ifdef ROPE_STRING_TRACE
+#define ROPE_TRACE_SCOPE(op, bytes) ::Rope::trace::Scope rope_trace_scope_(::Rope::trace::Op::op, (bytes))
+#define ROPE_TRACE_EVENT(op, bytes) ::Rope::trace::registry().record(::Rope::trace::Op::op, (bytes), 0, false)
+#else
+#define ROPE_TRACE_SCOPE(op, bytes) ((void)0)
+#define ROPE_TRACE_EVENT(op, bytes) ((void)0)
+#endif
+
+#endif //ROPE_TRACE_H
@@ -4,4 +4,16 @@ export module Rope.Tree;
 
 export namespace Rope {
     using Rope::Tree;
+    using Rope::Anchor;
+    using Rope::Gravity;
+    using Rope::Journal;
+    using Rope::Change;
+    using Rope::CompactPolicy;
+    using Rope::Stats;
+    using Rope::SizePolicy;
+    using Rope::ChunkPolicy;
+    using Rope::DefaultChunks;
+    using Rope::SmallChunks;
+    using Rope::MediumChunks;
+    using Rope::LargeChunks;
 }
\ No newline at end of file
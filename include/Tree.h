@@ -1,35 +1,106 @@
 #ifndef ROPE_TREE_H
 #define ROPE_TREE_H
 #include <Node.h>
+#include <Policy.h>
+#include <Anchor.h>
+#include <Journal.h>
+#include <SizeIndex.h>
+#include <Parallel.h>
+#include <Trace.h>
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <numeric>
+#include <span>
+#include <deque>
+#include <stdexcept>
+#include <string_view>
+#include <atomic>
+#include <iterator>
+#include <ranges>
 
-#ifndef ROPE_STRING_MAX_ROOT_SIZE
-#define ROPE_STRING_MAX_ROOT_SIZE 512
-#endif
 namespace Rope {
-    constexpr std::size_t max_root_size = ROPE_STRING_MAX_ROOT_SIZE;
-    template<typename CharT, typename Traits = std::char_traits<CharT>, typename Allocator = std::allocator<CharT>>
+    /*
+     * When a root counts as fragmented: less than `min_fill` of its leaf capacity holds characters.
+     * With `automatic` every edit repacks the fragmented roots it touched.
+     */
+    struct CompactPolicy {
+        double min_fill = 0.5;
+        bool automatic = false;
+    };
+    /*
+     * Shape and memory of a tree, see Tree::stats(). Byte counts cover the leaves
+     * and the roots vector; control blocks are estimated as a vtable pointer and two counters.
+     */
+    struct Stats {
+        std::size_t characters = 0;
+        std::size_t roots = 0;
+        std::size_t empty_roots = 0;
+        std::size_t leaves = 0;
+        std::size_t empty_leaves = 0;
+        std::size_t depth = 0;                     // roots vector plus the longest leaf chain
+        std::size_t leaf_size = 0;                 // leaf capacity of the tree's policy
+        std::array<std::size_t, 10> fill_histogram {}; // leaves by size / leaf_size in tenths, full ones in the last
+        std::size_t payload_bytes = 0;             // characters stored
+        std::size_t node_bytes = 0;                // Node objects without their string member
+        std::size_t string_header_bytes = 0;       // std::basic_string objects inside the nodes
+        std::size_t control_block_bytes = 0;       // shared_ptr control blocks (estimate)
+        std::size_t string_heap_bytes = 0;         // heap buffers of leaf strings past SSO, slack included
+        std::size_t root_vector_bytes = 0;         // roots vector capacity
+
+        auto totalBytes() const -> std::size_t {
+            return node_bytes + string_header_bytes + control_block_bytes + string_heap_bytes + root_vector_bytes;
+        }
+        auto overheadBytes() const -> std::size_t { return totalBytes() - std::min(totalBytes(), payload_bytes); }
+        // Characters per available leaf slot, 1 when every leaf is full
+        auto fillRatio() const -> double {
+            return leaves ? static_cast<double>(characters) / static_cast<double>(leaves * leaf_size) : 0.0;
+        }
+    };
+    template<typename CharT, typename Traits = std::char_traits<CharT>, typename Allocator = std::allocator<CharT>, SizePolicy Policy = DefaultChunks>
     class Tree {
+    public:
+        using policy_type = Policy;
+        using value_type = CharT;
+        // Chunk sizes of this tree, member functions see these instead of the Rope:: defaults
+        static constexpr std::size_t max_leaf_size = Policy::leaf_size;
+        static constexpr std::size_t max_root_size = Policy::root_size;
+    private:
         using NodeType = Node<CharT, Traits, Allocator>;
         using StringType = std::basic_string<CharT, Traits, Allocator>;
-        std::vector<std::pair<std::shared_ptr<NodeType>, std::size_t>> roots;
+        using AllocTraits = std::allocator_traits<Allocator>;
+        // A moved-from tree hands its nodes over unless the allocators may differ, as with std::pmr
+        static constexpr bool nothrow_move_assign = AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value;
+        using RootType = std::pair<std::shared_ptr<NodeType>, std::size_t>;
+        // Nodes, their shared_ptr control blocks and the roots vector all come from the tree's allocator
+        using NodeAllocator = typename AllocTraits::template rebind_alloc<NodeType>;
+        using RootVector = std::vector<RootType, typename AllocTraits::template rebind_alloc<RootType>>;
+        using Bucket = std::vector<std::shared_ptr<Mark>>;
+        RootVector roots;
+        SizeIndex<typename AllocTraits::template rebind_alloc<std::size_t>> sizes; // prefix sums of the root sizes, in step with `roots`
+        std::vector<Bucket> marks; // anchor buckets, one per root, grown lazily
+        std::unique_ptr<Journal> journal_; // null until enableJournal()
+        NodeType *tail = nullptr; // rightmost leaf of the last root, null when it has to be looked up again
+        bool adopted_ = false; // a root may hold a leaf past max_leaf_size taken over by adopt(), see splitAdopted()
+        std::uint64_t revision_ = 0; // bumped before every change of the content, never copied between trees
+        CompactPolicy policy;
         Allocator allocator;
 
         void insertAfter(NodeType* leaf, std::shared_ptr<NodeType> new_leaf, std::size_t root_index) {
             if (roots[root_index].second + new_leaf->str.size() >= max_root_size) {
                 leaf->ending_node = true;
-                roots.emplace_back(new_leaf, new_leaf->str.size());
+                appendRoot(new_leaf, new_leaf->str.size());
                 return;
             }
             // Link the new leaf into the right chain of `leaf` (sibling chain)
             new_leaf->right = leaf->right;
-            new_leaf->top = leaf->top; // keep same parent context if used
+            new_leaf->top = leaf;
+            if (new_leaf->right) new_leaf->right->top = new_leaf.get();
             leaf->right = new_leaf;
 
             // Update size of the current root incrementally
-            roots[root_index].second += new_leaf->str.size();
+            growRoot(root_index, new_leaf->str.size());
         }
         void shiftLeaf(NodeType* leaf, std::size_t n) {
             if (!leaf || n == 0) return;
@@ -40,159 +111,1096 @@ namespace Rope {
             std::shared_ptr<NodeType> prev = leaf->shared_from_this();
 
             for (std::size_t i = 0; i < n; ++i) {
-                auto new_leaf = std::make_shared<NodeType>();
+                auto new_leaf = newLeaf(allocator);
                 new_leaf->str.clear();
 
                 // Insert to the right of `prev` in sibling chain
                 prev->right = new_leaf;
                 new_leaf->right = nullptr;
-                new_leaf->top = leaf->top;
+                new_leaf->top = prev.get();
 
                 prev = new_leaf; // move forward
             }
 
             // Connect the tail back to the old right chain
             prev->right = old_right;
+            if (old_right) old_right->top = prev.get();
         }
+        // Remove `n` characters starting at root-local `local`, unlinking leaves that become empty
+        void eraseFromRoot(std::size_t root, std::size_t local, std::size_t n) {
+            if (n == 0) return;
+            detach(root);
+            tail = nullptr;
+            shrinkRoot(root, n);
 
-    public:
-        using Node = NodeType;
+            NodeType* prev = nullptr;
+            NodeType* leaf = roots[root].first.get();
+            std::size_t pos = 0;
+            while (leaf && n > 0) {
+                if (local < pos + leaf->str.size()) {
+                    auto from = local - pos;
+                    auto take = std::min(n, leaf->str.size() - from);
+                    leaf->str.erase(from, take);
+                    n -= take;
+                }
+                pos += leaf->str.size();
+                NodeType* next = leaf->right.get();
+                if (leaf->str.empty() && prev) {
+                    auto hold = std::move(prev->right);
+                    prev->right = hold->right;
+                    if (prev->right) prev->right->top = prev;
+                } else {
+                    prev = leaf;
+                }
+                leaf = next;
+            }
 
-        Tree() {
-            roots.emplace_back(std::make_shared<NodeType>("", allocator), 0);
-        }
-        Tree(Allocator allocator) : allocator(allocator) {
-            roots.emplace_back(std::make_shared<NodeType>("", allocator), 0);
+            // The root node must stay non-empty while the root holds anything, pull the next leaf up
+            auto &head = roots[root].first;
+            if (head->str.empty() && head->right) {
+                auto hold = head->right;
+                head->str = std::move(hold->str);
+                head->right = hold->right;
+                if (head->right) head->right->top = head.get();
+            }
         }
-
-        void push(const StringType &str) {
+        /*
+         * Append at the end. The rightmost leaf is topped up first and new leaves are filled completely,
+         * so appending char by char allocates a leaf only every max_leaf_size characters.
+         * `take(str, n)` appends the next n of the `count` characters to a leaf string.
+         */
+        template<typename Take>
+        void pushLeaves(std::size_t count, Take &&take) {
             std::size_t index = 0;
+            std::size_t last = roots.size() - 1;
+            std::size_t old_end = roots[last].second;
 
-            while (index < str.size()) {
-                // If no roots exist or last root is full, create a new root
-                if (roots.empty() || roots.back().second >= max_root_size) {
-                    roots.emplace_back(std::make_shared<NodeType>(StringType(), allocator), 0);
+            while (index < count) {
+                // Last root is full, start a new one
+                if (roots.back().second >= max_root_size) {
+                    appendRoot(newLeaf(allocator), 0);
+                    tail = roots.back().first.get();
                 }
 
-                auto &current_root = roots.back();
-                std::size_t space_in_root = max_root_size - roots.back().second;
-                std::size_t chunk_size = std::min(space_in_root, str.size() - index);
+                auto current_root = roots.size() - 1;
+                detach(current_root);
+                std::size_t space_in_root = max_root_size - roots[current_root].second;
+                std::size_t chunk_size = std::min(space_in_root, count - index);
 
-                // Split chunk into leaves
-                std::vector<std::shared_ptr<NodeType>> leaves;
-                for (std::size_t i = 0; i < chunk_size; i += max_leaf_size) {
-                    size_t leaf_size = std::min(max_leaf_size, chunk_size - i);
-                    leaves.push_back(std::make_shared<NodeType>(StringType(str, index + i, leaf_size), allocator));
-                }
+                NodeType* right_most = tailLeaf();
+                std::size_t fill = std::min(chunk_size, max_leaf_size - std::min(max_leaf_size, right_most->str.size()));
+                take(right_most->str, fill);
 
-                // If no leaves (shouldn’t happen), skip
-                if (leaves.empty()) break;
-                // If current_root.str is empty, move first leaf’s str into it
-                if (current_root.first->str.empty()) {
-                    current_root.first->str = std::move(leaves.front()->str);
-                    leaves.front()->str.clear();
+                // The rest of the chunk goes into new full leaves
+                for (std::size_t i = fill; i < chunk_size; i += max_leaf_size) {
+                    auto leaf = newLeaf(allocator);
+                    take(leaf->str, std::min(max_leaf_size, chunk_size - i));
+                    leaf->top = right_most;
+                    right_most->right = leaf;
+                    right_most = leaf.get();
                 }
+                tail = right_most;
 
-                // Attach subtree to the rightmost leaf of current_root
-                NodeType* right_most = current_root.first.get();
-                while (right_most->right) right_most = right_most->right.get();
-
-                // Attach all remaining leaves except the first (already moved)
-                for (std::size_t i = 1; i < leaves.size(); ++i) {
-                    right_most->right = leaves[i];
-                    leaves[i]->top = right_most;
-                    right_most = leaves[i].get();
-                }
-
-                // Update weights along the path (best-effort, not critical for current usage)
-                NodeType* current = right_most;
-                while (current) {
-                    current->weight = (current->left ? current->left->size() : 0) + current->str.size();
-                    if (current->right && !current->ending_node) current->weight += current->right->size();
-                    current = current->top;
-                }
-
-                // Update root size incrementally by the amount appended into this root
-                current_root.second += chunk_size;
-
+                growRoot(current_root, chunk_size);
                 index += chunk_size;
             }
+            followEnd(last, old_end);
+        }
+        // Append a full leaf by linking `text` itself after the rightmost leaf, or as a new root once the last one is full
+        void linkLeaf(StringType &&text) {
+            ROPE_TRACE_SCOPE(Push, text.size() * sizeof(CharT));
+            if (journal_) journal_->record(size(), 0, text.size());
+            auto added = text.size();
+            auto last = roots.size() - 1;
+            auto old_end = roots[last].second;
+            if (old_end >= max_root_size) {
+                appendRoot(newLeaf(allocator, std::move(text)), added);
+                tail = roots.back().first.get();
+                ++revision_;
+            } else {
+                detach(last);
+                auto right_most = tailLeaf();
+                if (right_most->str.empty()) {
+                    right_most->str = std::move(text);
+                } else {
+                    auto leaf = newLeaf(allocator, std::move(text));
+                    leaf->top = right_most;
+                    right_most->right = leaf;
+                    tail = leaf.get();
+                }
+                growRoot(last, added);
+            }
+            followEnd(last, old_end);
+        }
+        void pushLeaves(std::basic_string_view<CharT, Traits> str) {
+            pushLeaves(str.size(), viewSource(str));
+        }
+        // Rightmost leaf of the last root, cached in `tail`
+        auto tailLeaf() -> NodeType* {
+            if (!tail) {
+                tail = roots.back().first.get();
+                while (tail->right) tail = tail->right.get();
+            }
+            return tail;
         }
 
-        void insert(std::size_t index, const std::basic_string<CharT, Traits, Allocator> &str) {
+        // Insert `count` characters produced by `take` (see pushLeaves) at `index`
+        template<typename Take>
+        void insertString(std::size_t index, std::size_t count, Take &&take) {
+            if (count == 0) return;
             if (index >= size()) {
-                push(str);
+                pushLeaves(count, take);
                 return;
             }
+            splitAdopted();
 
-            std::size_t offset = 0;
-            auto* leaf = getLeafByIndex(index, offset);
-            auto root_index = getRootByIndex(index);
+            auto [root_index, local] = locateRoot(index);
+            detach(root_index);
+            tail = nullptr;
+            std::size_t offset = local;
+            auto* leaf = roots[root_index].first->getLeafByIndex(offset);
+            // A position on a leaf boundary resolves to the start of the next leaf, append to the previous one
+            // instead while it has room, so typing fills leaves rather than leaving one character leaves behind
+            if (offset == 0 && leaf->top && leaf->top->str.size() < max_leaf_size) {
+                leaf = leaf->top;
+                offset = leaf->str.size();
+            }
 
             // Split the leaf at insertion point to preserve order
-            StringType tail;
+            StringType tail_text;
             if (offset < leaf->str.size()) {
-                tail.assign(leaf->str.begin() + offset, leaf->str.end());
+                tail_text.assign(leaf->str.begin() + offset, leaf->str.end());
                 leaf->str.erase(leaf->str.begin() + offset, leaf->str.end());
             }
 
             // Fill current leaf up to max_leaf_size
-            std::size_t begin_in_str = 0;
-            std::size_t can_take_here = std::min<std::size_t>(max_leaf_size - leaf->str.size(), str.size());
-            if (can_take_here > 0) {
-                leaf->str.insert(leaf->str.end(), str.begin(), str.begin() + can_take_here);
-                begin_in_str = can_take_here;
-            }
-            if (begin_in_str == str.size() && tail.empty()) {
-                // everything fits into current leaf; root size grows by the inserted amount
-                roots[root_index].second += str.size();
+            std::size_t begin_in_str = std::min(max_leaf_size - std::min(max_leaf_size, leaf->str.size()), count);
+            take(leaf->str, begin_in_str);
+            if (begin_in_str == count && leaf->str.size() + tail_text.size() <= max_leaf_size) {
+                // everything fits into current leaf together with its tail; root size grows by the inserted amount
+                leaf->str += tail_text;
+                growRoot(root_index, count);
+                markInsert(root_index, local, count);
+                boundRoot(root_index);
                 return;
             }
 
             // How many extra leaves needed for remaining insertion (+1 for tail if exists)?
-            std::size_t remaining = str.size() - begin_in_str;
+            std::size_t remaining = count - begin_in_str;
             std::size_t chunks = (remaining + max_leaf_size - 1) / max_leaf_size;
-            std::size_t extra = chunks + (tail.empty() ? 0 : 1);
+            std::size_t extra = chunks + (tail_text.empty() ? 0 : 1);
             shiftLeaf(leaf, extra);
 
             // Fill new leaves with remaining insertion
             auto current = leaf->right;
-            for (std::size_t i = begin_in_str; i < str.size(); i += max_leaf_size) {
-                auto end = std::min(i + max_leaf_size, str.size());
-                current->str.assign(str.begin() + i, str.begin() + end);
+            for (std::size_t i = begin_in_str; i < count; i += max_leaf_size) {
+                take(current->str, std::min(max_leaf_size, count - i));
                 current = current->right;
             }
 
             // Place the old tail after the inserted content
-            if (!tail.empty()) {
-                current->str = std::move(tail);
-                // advance to next (old right)
-                current = current->right;
-            }
+            if (!tail_text.empty())
+                current->str = std::move(tail_text);
 
             // Finally, root size increases by the total inserted length
-            roots[root_index].second += str.size();
+            growRoot(root_index, count);
+            markInsert(root_index, local, count);
+            maintain(root_index);
+            boundRoot(root_index);
+        }
+        void insertString(std::size_t index, std::basic_string_view<CharT, Traits> str) {
+            insertString(index, str.size(), viewSource(str));
+        }
+
+        // Sources for pushLeaves / insertString
+        static auto viewSource(std::basic_string_view<CharT, Traits> str) {
+            return [str, at = std::size_t(0)](StringType &out, std::size_t n) mutable {
+                out.append(str.data() + at, n);
+                at += n;
+            };
+        }
+        template<typename It>
+        static auto iteratorSource(It &first) {
+            return [&first](StringType &out, std::size_t n) {
+                if constexpr (std::contiguous_iterator<It> && std::same_as<std::iter_value_t<It>, CharT>) {
+                    out.append(std::to_address(first), n);
+                    first += static_cast<std::iter_difference_t<It>>(n);
+                } else {
+                    for (; n > 0; --n, ++first) out.push_back(static_cast<CharT>(*first));
+                }
+            };
+        }
+        // Characters of an iterator range: multi-pass ranges are read straight into the leaves,
+        // single-pass ones are buffered once first
+        template<std::input_iterator It, std::sentinel_for<It> S, typename Sink>
+        void withRange(It first, S last, Sink &&sink) {
+            if constexpr (std::forward_iterator<It>) {
+                auto count = static_cast<std::size_t>(std::ranges::distance(first, last));
+                sink(count, iteratorSource(first));
+            } else {
+                StringType buffer(allocator);
+                for (; first != last; ++first) buffer.push_back(static_cast<CharT>(*first));
+                sink(buffer.size(), viewSource(buffer));
+            }
+        }
 
+        void eraseRange(std::size_t index, std::size_t count) {
+            splitAdopted();
+            auto [root, local] = locateRoot(index);
+            auto first = root;
+            while (count > 0) {
+                auto take = std::min(count, roots[root].second - local);
+                eraseFromRoot(root, local, take);
+                markErase(root, local, take);
+                count -= take;
+                local = 0;
+                ++root;
+            }
+            for (auto i = first; i < root; ++i) normalizeMarks(i);
+            // back to front: a root maintain() cuts only moves the roots behind it
+            auto before = roots.size();
+            for (auto i = root; i-- > first;) maintain(i);
+            dropEmptied(first, root + (roots.size() - before));
+        }
+        /*
+         * Remove the roots in [first, last) an erase emptied, so cutting blocks does not leave a trail of
+         * empty roots behind. The last root of the tree stays, the roots behind the removed ones move up
+         * together with their marks; the marks of an emptied root were already normalized onto the next one.
+         */
+        void dropEmptied(std::size_t first, std::size_t last) {
+            last = std::min(last, roots.size() - 1);
+            std::size_t out = first;
+            for (auto i = first; i < roots.size(); ++i) {
+                if (i < last && roots[i].second == 0) continue;
+                if (out != i) {
+                    roots[out] = std::move(roots[i]);
+                    if (out < marks.size()) marks[out] = i < marks.size() ? std::move(marks[i]) : Bucket();
+                    if (out < marks.size())
+                        for (auto &mark : marks[out]) mark->root = out;
+                }
+                ++out;
+            }
+            if (out == roots.size()) return;
+            roots.erase(roots.begin() + static_cast<std::ptrdiff_t>(out), roots.end());
+            if (marks.size() > out) marks.resize(out);
+            sizes.assign(roots);
+            tail = nullptr;
         }
 
-        auto getRootByIndex(std::size_t index) const -> std::size_t {
+        auto leafCount(std::size_t root) const -> std::size_t {
+            std::size_t count = 0;
+            for (auto leaf = roots[root].first.get(); leaf; leaf = leaf->right.get()) ++count;
+            return count;
+        }
+        // Share of the leaf capacity of a root that holds characters
+        auto fillRatio(std::size_t root) const -> double {
+            return static_cast<double>(roots[root].second) / static_cast<double>(leafCount(root) * max_leaf_size);
+        }
+        // Rebuild one root as a chain of full leaves, its size and anchors stay as they are
+        void repackRoot(std::size_t root) {
+            auto &[head, root_size] = roots[root];
+            if (root_size == 0 || !head->right) return;
+            StringType flat(allocator);
+            flat.reserve(root_size);
+            for (auto leaf = head.get(); leaf; leaf = leaf->right.get()) flat += leaf->str;
+            head = makeRoot(flat.data(), flat.size(), allocator);
+            tail = nullptr;
+        }
+        /*
+         * Cut roots whose head is a leaf taken over by adopt() into regular roots, before an edit that
+         * would otherwise move the characters of an oversized leaf around on every call.
+         */
+        void splitAdopted() {
+            if (!adopted_) return;
+            splitRoots([](const RootType &root) { return root.first->str.size() > max_leaf_size; });
+            adopted_ = false;
+        }
+        /*
+         * Inserts grow a root past max_root_size, it is then cut into halves of full leaves. The next cut of
+         * either half is at least max_root_size / 2 inserted characters away, so the cost is amortized.
+         */
+        void boundRoot(std::size_t root) {
+            if (roots[root].second <= max_root_size) return;
+            splitRoots([target = roots[root].first.get()](const RootType &r) { return r.first.get() == target; });
+        }
+        // Cut the roots `oversized` picks into even regular roots of full leaves, anchors keep their offsets
+        template<typename Pred>
+        void splitRoots(Pred &&oversized) {
+            if (std::none_of(roots.begin(), roots.end(), oversized)) return;
+            auto moved = takeMarks();
+            RootVector result(roots.get_allocator());
+            for (auto &root : roots) {
+                if (!oversized(root)) {
+                    result.push_back(std::move(root));
+                    continue;
+                }
+                StringType flat(allocator);
+                const StringType *text = &root.first->str;
+                if (root.first->right) {
+                    flat.reserve(root.second);
+                    for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) flat += leaf->str;
+                    text = &flat;
+                }
+                auto pieces = (root.second + max_root_size - 1) / max_root_size;
+                auto per_piece = (root.second + pieces - 1) / pieces;
+                for (std::size_t used = 0; used < root.second; used += per_piece) {
+                    auto count = std::min(per_piece, root.second - used);
+                    result.emplace_back(makeRoot(text->data() + used, count, allocator), count);
+                }
+            }
+            setRoots(std::move(result));
+            tail = nullptr;
+            ++revision_;
+            placeMarks(std::move(moved));
+        }
+        // Detach every anchor together with its global offset, for restructurings that rebuild the roots
+        auto takeMarks() -> std::vector<std::pair<std::size_t, std::shared_ptr<Mark>>> {
+            std::vector<std::pair<std::size_t, std::shared_ptr<Mark>>> moved;
+            std::size_t start = 0;
+            for (std::size_t root = 0; root < roots.size(); ++root) {
+                if (root < marks.size())
+                    for (auto &mark : marks[root])
+                        if (!dropped(mark)) moved.emplace_back(start + mark->offset, std::move(mark));
+                start += roots[root].second;
+            }
+            marks.clear();
+            return moved;
+        }
+        void placeMarks(std::vector<std::pair<std::size_t, std::shared_ptr<Mark>>> moved) {
+            std::sort(moved.begin(), moved.end(), [](auto &a, auto &b) { return a.first < b.first; });
+            std::size_t r = 0, pre = 0;
+            for (auto &[offset, mark] : moved) {
+                while (r + 1 < roots.size() && pre + roots[r].second <= offset) {
+                    pre += roots[r].second;
+                    ++r;
+                }
+                mark->root = r;
+                mark->offset = offset - pre;
+                bucket(r).push_back(mark);
+            }
+        }
+        // Automatic compaction: an edited root whose leaves fell below the fill threshold is repacked and,
+        // like compact() does, cut when it holds more than max_root_size; the work is bounded by the size of
+        // the root the edit already walked
+        void maintain(std::size_t root) {
+            if (!policy.automatic || !roots[root].second) return;
+            if (fillRatio(root) < policy.min_fill) repackRoot(root);
+            boundRoot(root);
+        }
+
+        /*
+         * Copies of a tree share their roots. Before writing into a root that someone else
+         * still references its leaf chain is cloned, so copies and published snapshots never change.
+         */
+        void detach(std::size_t root) {
+            ++revision_;
+            auto &head = roots[root].first;
+            if (head.use_count() == 1) {
+                // pairs with the release of the last other owner letting go
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return;
+            }
+            tail = nullptr;
+            head = cloneRoot(*head, allocator);
+        }
+        // A copy of the leaf chain starting at `head`, allocated with `allocator`
+        static auto cloneRoot(const NodeType &head, const Allocator &allocator) -> std::shared_ptr<NodeType> {
+            auto copy = newLeaf(allocator, head.str);
+            copy->weight = head.weight;
+            copy->ending_node = head.ending_node;
+            NodeType* prev = copy.get();
+            for (auto leaf = head.right.get(); leaf; leaf = leaf->right.get()) {
+                auto clone = newLeaf(allocator, leaf->str);
+                clone->weight = leaf->weight;
+                clone->ending_node = leaf->ending_node;
+                clone->top = prev;
+                prev->right = clone;
+                prev = clone.get();
+            }
+            return copy;
+        }
+        // Take the roots of `other`: shared when both trees allocate alike, cloned into this tree's allocator otherwise
+        void shareRoots(const Tree &other) {
+            adopted_ = other.adopted_;
+            if (allocator == other.allocator) {
+                roots = other.roots;
+                sizes.assign(roots);
+                return;
+            }
+            RootVector result(roots.get_allocator());
+            result.reserve(other.roots.size());
+            for (auto &[head, size] : other.roots) result.emplace_back(cloneRoot(*head, allocator), size);
+            setRoots(std::move(result));
+        }
+        // Every change of the roots goes through these, so `sizes` stays in step with them
+        void appendRoot(std::shared_ptr<NodeType> head, std::size_t size) {
+            roots.emplace_back(std::move(head), size);
+            sizes.push(size);
+        }
+        void growRoot(std::size_t root, std::size_t n) {
+            roots[root].second += n;
+            sizes.grow(root, n);
+        }
+        void shrinkRoot(std::size_t root, std::size_t n) {
+            roots[root].second -= n;
+            sizes.shrink(root, n);
+        }
+        void setRoots(RootVector &&result) {
+            roots = std::move(result);
+            sizes.assign(roots);
+        }
+        // A leaf constructed from `args` and `allocator`, its string and control block both use `allocator`
+        template<typename... Args>
+        static auto newLeaf(const Allocator &allocator, Args&&... args) -> std::shared_ptr<NodeType> {
+            ROPE_TRACE_EVENT(LeafAlloc, sizeof(NodeType));
+            return std::allocate_shared<NodeType>(NodeAllocator(allocator), std::forward<Args>(args)..., allocator);
+        }
+        // A root holding `count` characters of `data` as a chain of full leaves
+        static auto makeRoot(const CharT *data, std::size_t count, const Allocator &allocator) -> std::shared_ptr<NodeType> {
+            auto head = newLeaf(allocator, data, std::min(count, max_leaf_size));
+            NodeType* prev = head.get();
+            for (std::size_t i = max_leaf_size; i < count; i += max_leaf_size) {
+                auto leaf = newLeaf(allocator, data + i, std::min(max_leaf_size, count - i));
+                leaf->top = prev;
+                prev->right = leaf;
+                prev = leaf.get();
+            }
+            return head;
+        }
+        // Root `root` as a chain of `count` leaves taken from next()
+        template<typename Next>
+        void assembleRoot(std::size_t root, std::size_t count, Next &&next) {
+            auto head = count ? newLeaf(allocator, next()) : newLeaf(allocator);
+            auto size = head->str.size();
+            NodeType* prev = head.get();
+            for (std::size_t i = 1; i < count; ++i) {
+                auto leaf = newLeaf(allocator, next());
+                size += leaf->str.size();
+                leaf->top = prev;
+                prev->right = leaf;
+                prev = leaf.get();
+            }
+            roots[root] = {std::move(head), size};
+        }
+        /*
+         * After assemble(): roots written with larger chunk sizes are cut into regular ones.
+         * Edits let a root run past max_root_size by less than a leaf, only more than that counts as larger.
+         */
+        void regularize() {
+            splitRoots([](const RootType &root) {
+                if (root.second > max_root_size + max_leaf_size) return true;
+                for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get())
+                    if (leaf->str.size() > max_leaf_size) return true;
+                return false;
+            });
+        }
+        void buildRoot(std::span<const CharT> text, std::size_t root) {
+            auto begin = root * max_root_size;
+            auto count = std::min(max_root_size, text.size() - begin);
+            roots[root] = {makeRoot(text.data() + begin, count, allocator), count};
+        }
+
+        /*
+         * Anchor bookkeeping. A mark lives in the bucket of the root that contains its position,
+         * or at the end of the last root, so an edit only visits the marks of the roots it touches.
+         * Buckets are sorted by offset: an edit finds its position by binary search and shifts the marks behind it.
+         * Marks held by the bucket alone were dropped by their anchors and are pruned when an edit passes them.
+         */
+        auto bucket(std::size_t root) -> Bucket& {
+            if (marks.size() <= root) marks.resize(root + 1);
+            return marks[root];
+        }
+        static auto dropped(const std::shared_ptr<Mark> &mark) -> bool { return mark.use_count() == 1; }
+        // First mark of a sorted bucket at or past `offset`
+        static auto lowerMark(Bucket &marks, std::size_t offset) -> typename Bucket::iterator {
+            return std::partition_point(marks.begin(), marks.end(), [offset](auto &mark) { return mark->offset < offset; });
+        }
+        // Marks of one offset with left gravity first, returns the first right gravity one
+        static auto rightOf(typename Bucket::iterator first, typename Bucket::iterator last) -> typename Bucket::iterator {
+            auto offset = (*first)->offset;
+            last = std::partition_point(first, last, [offset](auto &mark) { return mark->offset == offset; });
+            return std::stable_partition(first, last, [](auto &mark) { return mark->gravity == Gravity::Left; });
+        }
+        // Move the marks [first, end) of bucket `from` to `offset` in root `to`, in front of its marks or behind them
+        void moveMarks(std::size_t from, typename Bucket::iterator first, std::size_t to, std::size_t offset, bool front) {
+            auto &source = marks[from];
+            for (auto it = first; it != source.end(); ++it) {
+                (*it)->root = to;
+                (*it)->offset = offset;
+            }
+            if (from == to) return;
+            auto at = first - source.begin();
+            auto &target = bucket(to);
+            auto &moving = marks[from]; // bucket() may have grown `marks`
+            target.insert(front ? target.begin() : target.end(),
+                          std::make_move_iterator(moving.begin() + at), std::make_move_iterator(moving.end()));
+            moving.erase(moving.begin() + at, moving.end());
+        }
+        // Text was appended behind the old end of root `last`: right gravity marks there follow it to the new end
+        void followEnd(std::size_t last, std::size_t old_end) {
+            if (last >= marks.size()) return;
+            auto &b = marks[last];
+            auto first = lowerMark(b, old_end);
+            if (first != b.end()) moveMarks(last, rightOf(first, b.end()), roots.size() - 1, roots.back().second, false);
+            normalizeMarks(last);
+        }
+        auto canonicalRoot(std::size_t root) const -> std::size_t {
+            while (root + 1 < roots.size() && roots[root].second == 0) ++root;
+            return root;
+        }
+        void normalizeMarks(std::size_t root) {
+            if (root + 1 >= roots.size() || root >= marks.size()) return;
+            auto first = lowerMark(marks[root], roots[root].second);
+            if (first != marks[root].end()) moveMarks(root, first, canonicalRoot(root + 1), 0, true);
+        }
+        void markInsert(std::size_t root, std::size_t offset, std::size_t length) {
+            if (root >= marks.size()) return;
+            auto &b = marks[root];
+            auto first = lowerMark(b, offset);
+            if (first != b.end() && (*first)->offset == offset) first = rightOf(first, b.end());
+            for (auto it = first; it != b.end(); ++it) (*it)->offset += length;
+            b.erase(std::remove_if(first, b.end(), dropped), b.end());
+        }
+        void markErase(std::size_t root, std::size_t offset, std::size_t length) {
+            if (root >= marks.size()) return;
+            auto &b = marks[root];
+            auto first = lowerMark(b, offset + 1);
+            for (auto it = first; it != b.end(); ++it) {
+                auto &mark = **it;
+                if (mark.offset >= offset + length) mark.offset -= length;
+                else mark.offset = offset;
+            }
+            b.erase(std::remove_if(first, b.end(), dropped), b.end());
+        }
+        // Whole content was replaced: left gravity marks go to the start, right gravity ones to the end
+        void resetMarks() {
+            if (marks.empty()) return;
+            auto old = std::move(marks);
+            marks.clear();
+            auto first = canonicalRoot(0);
+            auto last = roots.size() - 1;
+            for (auto gravity : {Gravity::Left, Gravity::Right}) {
+                for (auto &b : old) {
+                    for (auto &mark : b) {
+                        if (dropped(mark) || mark->gravity != gravity) continue;
+                        bool right = gravity == Gravity::Right;
+                        mark->root = right ? last : first;
+                        mark->offset = right ? roots[last].second : 0;
+                        bucket(mark->root).push_back(mark);
+                    }
+                }
+            }
+        }
+
+    public:
+        using Node = NodeType;
+        // One edit of a batch: replace `count` characters at `offset` with `text`
+        struct Edit {
             std::size_t offset = 0;
-            for (std::size_t i = 0; i < roots.size(); ++i) {
-                if (index < offset + roots[i].second) return i;
-                offset += roots[i].second;
+            std::size_t count = 0;
+            std::basic_string_view<CharT, Traits> text;
+        };
+
+        Tree() {
+            appendRoot(newLeaf(allocator), 0);
+        }
+        Tree(Allocator allocator) : roots(allocator), sizes(allocator), allocator(allocator) {
+            appendRoot(newLeaf(allocator), 0);
+        }
+        // Anchors and the journal belong to one tree, copies start without them
+        Tree(const Tree &other) : Tree(other, AllocTraits::select_on_container_copy_construction(other.allocator)) {}
+        // A copy allocating from `allocator`, it shares the roots of `other` only if the allocators compare equal
+        Tree(const Tree &other, const Allocator &allocator) : roots(allocator), sizes(allocator), policy(other.policy), allocator(allocator) {
+            shareRoots(other);
+        }
+        Tree(Tree &&other) noexcept
+            : roots(std::move(other.roots)), sizes(std::move(other.sizes)), marks(std::move(other.marks)), journal_(std::move(other.journal_)),
+              tail(std::exchange(other.tail, nullptr)), adopted_(other.adopted_), policy(other.policy), allocator(std::move(other.allocator)) {}
+        auto operator=(const Tree &other) -> Tree& {
+            if (this != &other) {
+                if (journal_) journal_->record(0, size(), other.size());
+                if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) allocator = other.allocator;
+                shareRoots(other);
+                tail = nullptr;
+                ++revision_;
+                resetMarks();
+            }
+            return *this;
+        }
+        auto operator=(Tree &&other) noexcept(nothrow_move_assign) -> Tree& {
+            if (this != &other) {
+                if (journal_) journal_->record(0, size(), other.size());
+                if constexpr (AllocTraits::propagate_on_container_move_assignment::value) allocator = std::move(other.allocator);
+                if (allocator == other.allocator) {
+                    roots = std::move(other.roots);
+                    sizes = std::move(other.sizes);
+                    tail = std::exchange(other.tail, nullptr);
+                    adopted_ = other.adopted_;
+                } else {
+                    // the nodes of `other` must not outlive its allocator here, copy them into ours
+                    shareRoots(other);
+                    tail = nullptr;
+                }
+                ++revision_;
+                ++other.revision_;
+                resetMarks();
             }
-            return roots.size() - 1;
+            return *this;
+        }
+        void swap(Tree &other) noexcept {
+            using std::swap;
+            swap(roots, other.roots);
+            sizes.swap(other.sizes);
+            swap(marks, other.marks);
+            swap(journal_, other.journal_);
+            swap(tail, other.tail);
+            swap(adopted_, other.adopted_);
+            // like the standard containers: allocators that do not propagate on swap must compare equal
+            if constexpr (AllocTraits::propagate_on_container_swap::value) swap(allocator, other.allocator);
+            ++revision_;
+            ++other.revision_;
         }
 
-        auto getLeafByIndex(std::size_t index, std::size_t &offset) const -> NodeType* {
-            for (std::size_t i = 0; i < roots.size(); ++i) {
-                if (index < offset + roots[i].second) {
-                    offset = index - offset;
-                    return roots[i].first->getLeafByIndex(offset);
+        /*
+         * Build a tree from a buffer in one pass. The roots vector is sized up front and every root
+         * is cut from its own slice of the buffer, so no leaf chain is walked and the roots
+         * can be built concurrently.
+         */
+        static auto build(std::span<const CharT> text, const Allocator &allocator = Allocator()) -> Tree {
+            Tree result(allocator);
+            if (text.empty()) return result;
+            result.roots.resize((text.size() + max_root_size - 1) / max_root_size);
+            for (std::size_t i = 0; i < result.roots.size(); ++i)
+                result.buildRoot(text, i);
+            result.sizes.assign(result.roots);
+            return result;
+        }
+        template<ParallelContext Context>
+        static auto build(Context &&context, std::span<const CharT> text, const Allocator &allocator = Allocator()) -> Tree {
+            Tree result(allocator);
+            if (text.empty()) return result;
+            auto count = (text.size() + max_root_size - 1) / max_root_size;
+            auto per_task = std::max<std::size_t>(1, parallel_grain / max_root_size);
+            result.roots.resize(count);
+            parallelFor(std::forward<Context>(context), (count + per_task - 1) / per_task, [&](std::size_t task) {
+                for (auto i = task * per_task; i < std::min(count, (task + 1) * per_task); ++i)
+                    result.buildRoot(text, i);
+            });
+            result.sizes.assign(result.roots);
+            return result;
+        }
+
+        /*
+         * Restore a saved chunk layout, see Serialize.h: root i is made of root_leaves[i] leaves and
+         * leaf(j) returns the text of leaf j. Leaves are taken as they are, so nothing is re-chunked,
+         * except roots that do not fit this tree's chunk sizes.
+         */
+        template<typename Leaf>
+        static auto assemble(std::span<const std::uint64_t> root_leaves, Leaf &&leaf, const Allocator &allocator = Allocator()) -> Tree {
+            Tree result(allocator);
+            if (root_leaves.empty()) return result;
+            result.roots.resize(root_leaves.size());
+            std::size_t next = 0;
+            for (std::size_t i = 0; i < root_leaves.size(); ++i)
+                result.assembleRoot(i, root_leaves[i], [&] { return leaf(next++); });
+            result.sizes.assign(result.roots);
+            result.regularize();
+            return result;
+        }
+        // leaf(j) is called concurrently for different leaves
+        template<ParallelContext Context, typename Leaf>
+        static auto assemble(Context &&context, std::span<const std::uint64_t> root_leaves, Leaf &&leaf, const Allocator &allocator = Allocator()) -> Tree {
+            Tree result(allocator);
+            if (root_leaves.empty()) return result;
+            std::vector<std::size_t> first(root_leaves.size());
+            std::exclusive_scan(root_leaves.begin(), root_leaves.end(), first.begin(), std::size_t(0));
+            result.roots.resize(root_leaves.size());
+            parallelFor(std::forward<Context>(context), root_leaves.size(), [&](std::size_t i) {
+                auto next = first[i];
+                result.assembleRoot(i, root_leaves[i], [&] { return leaf(next++); });
+            });
+            result.sizes.assign(result.roots);
+            result.regularize();
+            return result;
+        }
+
+        /*
+         * Change journal: once enabled every mutation is recorded as (offset, removed, inserted)
+         * for the cursors subscribed to it.
+         */
+        auto enableJournal() -> Journal& {
+            if (!journal_) journal_ = std::make_unique<Journal>();
+            return *journal_;
+        }
+        auto journal() const -> Journal* { return journal_.get(); }
+
+        void push(std::basic_string_view<CharT, Traits> str) {
+            ROPE_TRACE_SCOPE(Push, str.size() * sizeof(CharT));
+            if (journal_) journal_->record(size(), 0, str.size());
+            pushLeaves(str);
+        }
+        void push(CharT ch) {
+            push(std::basic_string_view<CharT, Traits>(&ch, 1));
+        }
+        void push(std::size_t count, CharT ch) {
+            ROPE_TRACE_SCOPE(Push, count * sizeof(CharT));
+            if (journal_) journal_->record(size(), 0, count);
+            pushLeaves(count, [ch](StringType &out, std::size_t n) { out.append(n, ch); });
+        }
+        template<std::input_iterator It, std::sentinel_for<It> S>
+        void push(It first, S last) {
+            ROPE_TRACE_SCOPE(Push, 0);
+            withRange(std::move(first), std::move(last), [&](std::size_t count, auto &&take) {
+                if (journal_) journal_->record(size(), 0, count);
+                pushLeaves(count, take);
+            });
+        }
+        // Remove the last character, O(1) unless the last root was emptied by an erase
+        void popBack() {
+            auto last = roots.size() - 1;
+            if (roots[last].second == 0 || tailLeaf()->str.empty()) {
+                auto total = size();
+                if (total) erase(total - 1, 1);
+                return;
+            }
+            if (journal_) journal_->record(size() - 1, 1, 0);
+            detach(last);
+            auto leaf = tailLeaf();
+            leaf->str.pop_back();
+            shrinkRoot(last, 1);
+            if (leaf->str.empty() && leaf->top) {
+                tail = leaf->top;
+                tail->right.reset();
+            }
+            markErase(last, roots[last].second, 1);
+        }
+        // Last character, writable: its root is unshared first
+        auto back() -> CharT& {
+            auto last = roots.size() - 1;
+            if (roots[last].second == 0 || tailLeaf()->str.empty()) {
+                auto total = size();
+                if (total == 0) throw std::out_of_range("Rope::Tree::back");
+                return charAt(total - 1);
+            }
+            detach(last);
+            return tailLeaf()->str.back();
+        }
+        auto back() const -> const CharT& {
+            for (auto it = roots.rbegin(); it != roots.rend(); ++it) {
+                if (it->second == 0) continue;
+                const NodeType* leaf = it == roots.rbegin() && tail ? tail : it->first->rightmostLeaf();
+                if (!leaf->str.empty()) return leaf->str.back();
+                std::size_t local = it->second - 1;
+                return it->first->getLeafByIndex(local)->str[local];
+            }
+            throw std::out_of_range("Rope::Tree::back");
+        }
+
+        /*
+         * Append the roots of `other` by moving them, no text is copied.
+         * Roots from a tree allocating differently are cloned into this tree's allocator instead,
+         * they must not outlive the memory of `other`. Anchors and the journal of `other` are dropped.
+         */
+        void splice(Tree &&other) {
+            auto added = other.size();
+            if (added == 0) return;
+            if (journal_) journal_->record(size(), 0, added);
+            auto last = roots.size() - 1;
+            auto old_end = roots[last].second;
+            bool foreign = allocator != other.allocator;
+            adopted_ = adopted_ || other.adopted_;
+            for (auto &root : other.roots) {
+                if (!root.second) continue;
+                appendRoot(foreign ? cloneRoot(*root.first, allocator) : std::move(root.first), root.second);
+            }
+            other.clear();
+            tail = nullptr;
+            ++revision_;
+            followEnd(last, old_end);
+        }
+        /*
+         * Append `str` by taking over its buffer as a root of one leaf, no characters are copied.
+         * The leaf may exceed max_leaf_size, the first edit inside it cuts it into regular roots.
+         * A buffer of exactly max_leaf_size characters is linked in as a regular leaf, a shorter one is copied.
+         */
+        void adopt(StringType &&str) {
+            if (str.size() < max_leaf_size || str.get_allocator() != allocator) {
+                push(std::basic_string_view<CharT, Traits>(str));
+                return;
+            }
+            if (str.size() == max_leaf_size) {
+                linkLeaf(std::move(str));
+                return;
+            }
+            ROPE_TRACE_SCOPE(Push, str.size() * sizeof(CharT));
+            auto added = str.size();
+            if (journal_) journal_->record(size(), 0, added);
+            auto last = roots.size() - 1;
+            auto old_end = roots[last].second;
+            auto leaf = newLeaf(allocator, std::move(str));
+            tail = leaf.get();
+            adopted_ = true;
+            ++revision_;
+            if (roots.size() == 1 && old_end == 0) {
+                // an empty tree becomes the adopted leaf alone, contiguous() then views it in place
+                roots[0].first = std::move(leaf);
+                growRoot(0, added);
+                markInsert(0, 0, added);
+                return;
+            }
+            appendRoot(std::move(leaf), added);
+            followEnd(last, old_end);
+        }
+
+        void insert(std::size_t index, std::basic_string_view<CharT, Traits> str) {
+            ROPE_TRACE_SCOPE(Insert, str.size() * sizeof(CharT));
+            if (journal_) journal_->record(std::min(index, size()), 0, str.size());
+            insertString(index, str);
+        }
+        // Bulk inserts: the new leaves are filled straight from the source and linked in once
+        void insert(std::size_t index, std::size_t count, CharT ch) {
+            ROPE_TRACE_SCOPE(Insert, count * sizeof(CharT));
+            if (journal_) journal_->record(std::min(index, size()), 0, count);
+            insertString(index, count, [ch](StringType &out, std::size_t n) { out.append(n, ch); });
+        }
+        template<std::input_iterator It, std::sentinel_for<It> S>
+        void insert(std::size_t index, It first, S last) {
+            ROPE_TRACE_SCOPE(Insert, 0);
+            withRange(std::move(first), std::move(last), [&](std::size_t count, auto &&take) {
+                if (journal_) journal_->record(std::min(index, size()), 0, count);
+                insertString(index, count, take);
+            });
+        }
+
+        void erase(std::size_t index, std::size_t count) {
+            ROPE_TRACE_SCOPE(Erase, count * sizeof(CharT));
+            auto total = size();
+            if (index >= total || count == 0) return;
+            count = std::min(count, total - index);
+            if (journal_) journal_->record(index, count, 0);
+            eraseRange(index, count);
+        }
+
+        void replace(std::size_t index, std::size_t count, std::basic_string_view<CharT, Traits> str) {
+            ROPE_TRACE_SCOPE(Replace, str.size() * sizeof(CharT));
+            auto total = size();
+            index = std::min(index, total);
+            count = std::min(count, total - index);
+            if (journal_) journal_->record(index, count, str.size());
+            if (count) eraseRange(index, count);
+            insertString(index, str);
+        }
+
+        /*
+         * Apply a batch of edits as one transaction. Offsets refer to the text before the call,
+         * edits may not overlap and touching ones are merged. Roots no edit reaches are reused
+         * as they are, the touched ones are repacked in a single left-to-right pass.
+         * Invalid batches throw before anything is changed.
+         */
+        void apply(std::span<const Edit> edits) {
+            ROPE_TRACE_SCOPE(Apply, edits.size());
+            auto total = size();
+            std::vector<Edit> sorted(edits.begin(), edits.end());
+            std::stable_sort(sorted.begin(), sorted.end(), [](const Edit &a, const Edit &b) {
+                return a.offset < b.offset;
+            });
+
+            std::vector<Edit> validated;
+            for (auto &edit : sorted) {
+                if (edit.offset > total || edit.count > total - edit.offset)
+                    throw std::out_of_range("Rope::Tree::apply");
+                if (edit.count == 0 && edit.text.empty()) continue;
+                if (!validated.empty() && edit.offset < validated.back().offset + validated.back().count)
+                    throw std::invalid_argument("Rope::Tree::apply: overlapping edits");
+                validated.push_back(edit);
+            }
+
+            // Merge touching edits, their texts are joined in `joined`
+            std::vector<Edit> plan;
+            std::deque<StringType> joined;
+            bool back_joined = false;
+            for (auto &edit : validated) {
+                if (!plan.empty()) {
+                    auto &back = plan.back();
+                    if (edit.offset == back.offset + back.count) {
+                        if (!back_joined) joined.emplace_back(back.text, allocator);
+                        joined.back() += edit.text;
+                        back.count += edit.count;
+                        back.text = joined.back();
+                        back_joined = true;
+                        continue;
+                    }
+                }
+                plan.push_back(edit);
+                back_joined = false;
+            }
+            if (plan.empty()) return;
+
+            // Build the new root list
+            Tree result(allocator);
+            result.setRoots(RootVector(roots.get_allocator()));
+            StringType pending(allocator);
+            auto flush = [&] {
+                if (pending.empty()) return;
+                result.appendRoot(newLeaf(allocator), 0);
+                result.tail = nullptr;
+                result.pushLeaves(pending);
+                pending.clear();
+            };
+            std::size_t next = 0, skip_until = 0, start = 0;
+            for (auto &[root, root_size] : roots) {
+                auto end = start + root_size;
+                bool touched = skip_until > start || (next < plan.size() && plan[next].offset < end);
+                if (!touched) {
+                    if (root_size) {
+                        flush();
+                        result.appendRoot(root, root_size);
+                    }
+                    start = end;
+                    continue;
+                }
+                std::size_t pos = start;
+                for (auto leaf = root.get(); leaf; leaf = leaf->right.get()) {
+                    std::size_t a = pos, b = pos + leaf->str.size();
+                    while (a < b) {
+                        if (a < skip_until) {
+                            a = std::min(b, skip_until);
+                            continue;
+                        }
+                        if (next < plan.size() && plan[next].offset <= a) {
+                            pending += plan[next].text;
+                            skip_until = a + plan[next].count;
+                            ++next;
+                            continue;
+                        }
+                        auto stop = next < plan.size() ? std::min(b, plan[next].offset) : b;
+                        pending.append(leaf->str, a - pos, stop - a);
+                        a = stop;
+                    }
+                    pos = b;
+                }
+                start = end;
+            }
+            // insertions at the very end
+            for (; next < plan.size(); ++next)
+                pending += plan[next].text;
+            flush();
+            if (result.roots.empty())
+                result.appendRoot(newLeaf(allocator), 0);
+
+            // Map anchors through the unmerged edits as if applied one by one: a mark inside an
+            // edited range lands at its start, or past the new text with right gravity
+            std::vector<std::pair<std::size_t, std::shared_ptr<Mark>>> moved;
+            std::vector<Bucket> new_marks;
+            std::vector<std::pair<std::size_t, std::size_t>> placement;
+            if (!marks.empty()) {
+                std::vector<std::size_t> prefix(roots.size(), 0);
+                for (std::size_t i = 1; i < roots.size(); ++i)
+                    prefix[i] = prefix[i - 1] + roots[i - 1].second;
+                std::vector<std::ptrdiff_t> shift(validated.size() + 1, 0);
+                for (std::size_t i = 0; i < validated.size(); ++i)
+                    shift[i + 1] = shift[i] + static_cast<std::ptrdiff_t>(validated[i].text.size()) - static_cast<std::ptrdiff_t>(validated[i].count);
+
+                for (auto &b : marks) {
+                    for (auto &mark : b) {
+                        if (dropped(mark)) continue;
+                        auto p = prefix[mark->root] + mark->offset;
+                        auto it = std::lower_bound(validated.begin(), validated.end(), p, [](const Edit &edit, std::size_t value) {
+                            return edit.offset + edit.count < value;
+                        });
+                        std::size_t mapped;
+                        if (it != validated.end() && it->offset <= p) {
+                            if (mark->gravity == Gravity::Right) {
+                                // pushed past this edit's text, straight into the next one when they touch
+                                while (std::next(it) != validated.end() && std::next(it)->offset == it->offset + it->count)
+                                    ++it;
+                                mapped = it->offset + shift[it - validated.begin()] + it->text.size();
+                            } else {
+                                mapped = it->offset + shift[it - validated.begin()];
+                            }
+                        } else {
+                            mapped = p + shift[it - validated.begin()];
+                        }
+                        moved.emplace_back(mapped, std::move(mark));
+                    }
+                }
+                std::sort(moved.begin(), moved.end(), [](auto &a, auto &b) { return a.first < b.first; });
+                std::size_t r = 0, pre = 0;
+                for (auto &[mapped, mark] : moved) {
+                    while (r + 1 < result.roots.size() && pre + result.roots[r].second <= mapped) {
+                        pre += result.roots[r].second;
+                        ++r;
+                    }
+                    placement.emplace_back(r, mapped - pre);
+                    if (new_marks.size() <= r) new_marks.resize(r + 1);
+                    new_marks[r].push_back(mark);
                 }
-                offset += roots[i].second;
             }
-            throw std::out_of_range("Rope::Tree::getLeadByIndex");
+
+            if (journal_) {
+                std::size_t delta_applied = 0;
+                for (auto &edit : plan) {
+                    journal_->record(edit.offset + delta_applied, edit.count, edit.text.size());
+                    delta_applied += edit.text.size() - edit.count;
+                }
+            }
+
+            // Commit, nothing below throws
+            roots = std::move(result.roots);
+            sizes = std::move(result.sizes);
+            ++revision_;
+            marks = std::move(new_marks);
+            tail = nullptr;
+            for (std::size_t i = 0; i < moved.size(); ++i) {
+                moved[i].second->root = placement[i].first;
+                moved[i].second->offset = placement[i].second;
+            }
+        }
+
+        /*
+         * Register a position that follows every later edit of this tree.
+         * Gravity decides the side it takes when text is inserted exactly at it.
+         */
+        auto anchor(std::size_t index, Gravity gravity = Gravity::Right) -> Anchor {
+            auto [root, local] = locateRoot(std::min(index, size()));
+            auto mark = std::make_shared<Mark>(Mark{root, local, gravity});
+            auto &b = bucket(root);
+            b.insert(lowerMark(b, local + 1), mark);
+            return Anchor(std::move(mark));
+        }
+        // O(log n) for n roots: the start of the mark's root comes from the size index
+        auto resolve(const Anchor &anchor) const -> std::size_t {
+            auto &mark = anchor.get();
+            return sizes.start(mark.root) + mark.offset;
+        }
+
+        // Writable access to one character, unsharing its root first
+        auto charAt(std::size_t index) -> CharT& {
+            auto [root, local] = locateRoot(index);
+            detach(root);
+            return roots[root].first->getLeafByIndex(local)->str[local];
+        }
+
+        /*
+         * The root holding `index` and the offset in it, O(log n) for n roots. Empty roots are skipped,
+         * a position at or past the end lands in the last root.
+         */
+        auto locateRoot(std::size_t index) const -> std::pair<std::size_t, std::size_t> {
+            return sizes.find(index);
+        }
+        // Characters in the roots before `root`
+        auto rootStart(std::size_t root) const -> std::size_t {
+            return sizes.start(root);
+        }
+        auto getRootByIndex(std::size_t index) const -> std::size_t {
+            return locateRoot(index).first;
+        }
+
+        auto getLeafByIndex(std::size_t index, std::size_t &offset) const -> NodeType* {
+            if (index >= size()) throw std::out_of_range("Rope::Tree::getLeadByIndex");
+            auto [root, local] = locateRoot(index);
+            offset = local;
+            return roots[root].first->getLeafByIndex(offset);
         }
         Node* nextLeaf(Node* node) const {
             if (!node) return nullptr;
@@ -245,19 +1253,132 @@ namespace Rope {
             return nullptr;
         }
         auto size() const -> std::size_t {
-            return std::accumulate(roots.begin(),  roots.end(), static_cast<std::size_t>(0), [](std::size_t acc, const auto &value) {
-                return acc + value.second;
-            });
+            return sizes.total();
+        }
+
+        /*
+         * Merge fragmented and rebalance badly sized roots: runs of roots that are emptied, less than half full,
+         * grown past max_root_size by inserts or below the fill threshold are repacked into full roots,
+         * the others are kept as they are.
+         * Content, anchors and the journal are unaffected.
+         */
+        void compact() {
+            auto healthy = [&](std::size_t root) {
+                auto size = roots[root].second;
+                return size >= max_root_size / 2 && size <= max_root_size && fillRatio(root) >= policy.min_fill;
+            };
+
+            auto moved = takeMarks();
+            RootVector result(roots.get_allocator());
+            StringType pending(allocator);
+            auto flush = [&](bool all) {
+                std::size_t used = 0;
+                while (pending.size() - used >= max_root_size || (all && used < pending.size())) {
+                    auto count = std::min(max_root_size, pending.size() - used);
+                    result.emplace_back(makeRoot(pending.data() + used, count, allocator), count);
+                    used += count;
+                }
+                pending.erase(0, used);
+            };
+            for (std::size_t root = 0; root < roots.size(); ++root) {
+                if (roots[root].second == 0) continue;
+                if (healthy(root)) {
+                    flush(true);
+                    result.push_back(roots[root]);
+                    continue;
+                }
+                for (auto leaf = roots[root].first.get(); leaf; leaf = leaf->right.get()) pending += leaf->str;
+                flush(false);
+            }
+            flush(true);
+            if (result.empty())
+                result.emplace_back(newLeaf(allocator), 0);
+
+            setRoots(std::move(result));
+            tail = nullptr;
+            ++revision_;
+            placeMarks(std::move(moved));
+        }
+        /*
+         * A tree of at most max_leaf_size characters spread over several leaves or roots is moved into
+         * a single leaf, so contiguous() can hand out its text. Content, anchors and the journal are unaffected.
+         */
+        void collapse() {
+            if (size() > max_leaf_size || contiguous()) return;
+            auto moved = takeMarks();
+            StringType flat(allocator);
+            for (auto &root : roots)
+                for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) flat += leaf->str;
+            auto total = flat.size();
+            RootVector result(roots.get_allocator());
+            result.emplace_back(newLeaf(allocator, std::move(flat)), total);
+            setRoots(std::move(result));
+            tail = nullptr;
+            ++revision_;
+            placeMarks(std::move(moved));
+        }
+        // The whole text when it lives in one leaf (a single root without a chain), else null
+        auto contiguous() const -> const StringType* {
+            return roots.size() == 1 && !roots[0].first->right ? &roots[0].first->str : nullptr;
+        }
+        // Changes whenever the content may have changed, to validate caches derived from the text
+        auto revision() const -> std::uint64_t { return revision_; }
+        // Walk every leaf once and report fragmentation and memory use
+        auto stats() const -> Stats {
+            Stats result;
+            result.leaf_size = max_leaf_size;
+            result.roots = roots.size();
+            result.root_vector_bytes = roots.capacity() * sizeof(typename decltype(roots)::value_type);
+            for (auto &[head, root_size] : roots) {
+                result.characters += root_size;
+                if (root_size == 0) ++result.empty_roots;
+                std::size_t chain = 0;
+                for (auto leaf = head.get(); leaf; leaf = leaf->right.get()) {
+                    ++chain;
+                    auto length = leaf->str.size();
+                    if (length == 0) ++result.empty_leaves;
+                    result.fill_histogram[std::min<std::size_t>(9, length * 10 / max_leaf_size)]++;
+                    // a string whose buffer lies inside the node uses the small string buffer
+                    auto data = reinterpret_cast<const char*>(leaf->str.data());
+                    auto object = reinterpret_cast<const char*>(&leaf->str);
+                    if (data < object || data >= object + sizeof(StringType))
+                        result.string_heap_bytes += (leaf->str.capacity() + 1) * sizeof(CharT);
+                }
+                result.leaves += chain;
+                result.depth = std::max(result.depth, chain + 1);
+            }
+            result.payload_bytes = result.characters * sizeof(CharT);
+            result.node_bytes = result.leaves * (sizeof(NodeType) - sizeof(StringType));
+            result.string_header_bytes = result.leaves * sizeof(StringType);
+            result.control_block_bytes = result.leaves * (sizeof(void*) + 2 * sizeof(long));
+            return result;
+        }
+
+        void setCompactPolicy(CompactPolicy compact_policy) { policy = compact_policy; }
+        auto compactPolicy() const -> CompactPolicy { return policy; }
+        // Anchors, a journal or a compact policy: state a copy of the text would not carry over
+        auto carriesState() const -> bool {
+            if (journal_ || policy.automatic || policy.min_fill != CompactPolicy{}.min_fill) return true;
+            for (auto &bucket : marks)
+                for (auto &mark : bucket)
+                    if (!dropped(mark)) return true;
+            return false;
         }
 
         void clear() {
-            roots = { std::make_pair<std::shared_ptr<NodeType>, std::size_t>({ std::make_shared<NodeType>("", allocator) }, 0) };
+            if (journal_) journal_->record(0, size(), 0);
+            RootVector result(roots.get_allocator());
+            result.emplace_back(newLeaf(allocator), 0);
+            setRoots(std::move(result));
+            tail = nullptr;
+            ++revision_;
+            resetMarks();
         }
         auto operator==(const Tree &other) const -> bool {
             return size() == other.size() && roots == other.roots;
         }
-        auto get_allocator() -> Allocator { return allocator; }
-        auto &getRoots() { return roots; }
+        auto get_allocator() const -> Allocator { return allocator; }
+        // Read only: root sizes are indexed, every change goes through the tree
         auto &getRoots() const { return roots; }
     };
 }
@@ -1,7 +1,7 @@
 #include "lib.h"
 
 int main() {
-    Rope::String str {"0123456789-9876543210"};
+    Test::String str {"0123456789-9876543210"};
     assert(str.data().size() != 1, "tree should be partitioned across multiple roots");
     std::cout << "at: " << str.at(5) << std::endl;
     assert(str.at(5) == '5', "str.at(5) expected '5'");
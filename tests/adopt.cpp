@@ -0,0 +1,44 @@
+#include "lib.h"
+#include <type_traits>
+
+int main() {
+    static_assert(std::is_nothrow_move_assignable_v<Test::String> && std::is_nothrow_move_constructible_v<Test::String>, "moves do not throw");
+    static_assert(std::is_nothrow_move_assignable_v<Rope::Tree<char, std::char_traits<char>, std::allocator<char>, Test::Chunks>>, "neither does the tree underneath");
+
+    // longer than the small string buffer of std::string, so data() is heap memory that can be taken over
+    std::string buffer = "hello adopted world";
+    auto data = buffer.data();
+    Test::String s(std::move(buffer));
+    assert(s == "hello adopted world" && s.view().data() == data, "construction takes over the buffer");
+
+    auto mark = s.anchor(14);
+    s.insert(5, ",");
+    s.erase(0, 1);
+    assert(s == "ello, adopted world" && s.resolve(mark) == 14, "edits split the adopted leaf and anchors follow");
+
+    std::string tail = " and some more text";
+    data = tail.data();
+    Test::String empty;
+    empty += std::move(tail);
+    assert(empty == " and some more text" && empty.view().data() == data, "appending to an empty string takes over the buffer");
+    s.append(std::string("!!!"));
+    s.insert(0, std::string(">>>"));
+    s.insert(s.size(), std::string("<<<"));
+    assert(s == ">>>ello, adopted world!!!<<<", "rvalue append and insert");
+
+    std::string assigned = "assigned longer text";
+    data = assigned.data();
+    s = std::move(assigned);
+    assert(s == "assigned longer text" && s.view().data() == data, "assignment takes over the buffer");
+
+    Test::String moved = std::move(s);
+    assert(moved == "assigned longer text" && moved.view().data() == data && s.empty(), "moving a string moves its tree");
+    s = "usable";
+    s.push_back('!');
+    assert(s == "usable!", "a moved-from string is empty and usable");
+
+    Test::String anchored("0123456789");
+    auto kept = anchored.anchor(4);
+    anchored = std::move(moved);
+    assert(anchored == "assigned longer text" && moved.empty() && anchored.resolve(kept) == anchored.size(), "assigning into a string with anchors keeps them");
+}
@@ -0,0 +1,77 @@
+#include "lib.h"
+#include <random>
+#include <vector>
+
+int main() {
+    Test::String s("0123456789abcdef");
+    auto left = s.anchor(4, Rope::Gravity::Left);
+    auto right = s.anchor(4, Rope::Gravity::Right);
+    auto tail = s.anchor(12);
+    auto end = s.anchor(s.size());
+
+    s.insert(4, "XY");
+    assert(s == "0123XY456789abcdef", "insert before anchors");
+    assert(s.resolve(left) == 4, "left gravity stays before inserted text");
+    assert(s.resolve(right) == 6, "right gravity moves past inserted text");
+    assert(s.resolve(tail) == 14, "anchor after insertion shifts");
+
+    s.erase(2, 10);
+    assert(s == "01abcdef", "erase across roots");
+    assert(s.resolve(left) == 2 && s.resolve(right) == 2, "erased anchors collapse to erase start");
+    assert(s.resolve(tail) == 4, "anchor after erase shifts back");
+
+    s.append("ghij");
+    assert(s.resolve(end) == s.size(), "right gravity end anchor follows append");
+    assert(s.resolve(tail) == 4, "append leaves earlier anchors alone");
+
+    s.replace(0, 2, "zz");
+    assert(s.resolve(tail) == 4, "same length replace keeps later anchors");
+
+    s.pop_back();
+    assert(s.resolve(end) == s.size(), "pop_back pulls end anchor back");
+
+    std::string expected = "zzabcdefghi";
+    for (auto c : s) {
+        assert(c == expected[0], "iteration after erase skips emptied roots");
+        expected.erase(0, 1);
+    }
+    assert(expected.empty(), "iteration visits every character");
+
+    // many anchors sharing roots and offsets, checked against positions tracked by hand
+    Test::String text(std::string(300, '.'));
+    std::mt19937 random(7);
+    std::vector<Rope::Anchor> anchors;
+    std::vector<std::size_t> expected_at;
+    for (std::size_t i = 0; i < 200; ++i) {
+        auto at = random() % (text.size() + 1);
+        anchors.push_back(text.anchor(at, random() % 2 ? Rope::Gravity::Left : Rope::Gravity::Right));
+        expected_at.push_back(at);
+    }
+    for (int step = 0; step < 400; ++step) {
+        auto total = text.size();
+        auto at = random() % (total + 1);
+        if (random() % 2 || total < 20) {
+            auto count = 1 + random() % 9;
+            if (random() % 4 == 0) at = total;
+            text.insert(at, std::string(count, 'x'));
+            for (std::size_t i = 0; i < anchors.size(); ++i)
+                if (expected_at[i] > at || (expected_at[i] == at && anchors[i].gravity() == Rope::Gravity::Right))
+                    expected_at[i] += count;
+        } else {
+            auto count = std::min<std::size_t>(1 + random() % 15, total - std::min(at, total));
+            text.erase(at, count);
+            for (auto &p : expected_at)
+                p = p >= at + count ? p - count : std::min(p, at);
+        }
+        if (step == 200) {
+            // dropped anchors are forgotten on the way, the others keep following
+            for (std::size_t i = anchors.size(); i-- > 0;)
+                if (i % 3 == 0) {
+                    anchors.erase(anchors.begin() + static_cast<std::ptrdiff_t>(i));
+                    expected_at.erase(expected_at.begin() + static_cast<std::ptrdiff_t>(i));
+                }
+        }
+    }
+    for (std::size_t i = 0; i < anchors.size(); ++i)
+        assert(text.resolve(anchors[i]) == expected_at[i], "anchors follow a long random edit sequence");
+}
@@ -0,0 +1,87 @@
+#include "lib.h"
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+int main() {
+    constexpr int producers = 4;
+    constexpr int lines = 2000;
+
+    // per-producer order: each producer's lines stay in order, every line arrives exactly once
+    {
+        Test::String log("start\n");
+        auto anchor = log.anchor(log.size());
+        {
+            Test::Appender appender(log, Rope::AppendOrder::PerProducer, 64);
+            std::vector<std::thread> threads;
+            for (int p = 0; p < producers; ++p) {
+                threads.emplace_back([&appender, p] {
+                    auto producer = appender.producer();
+                    for (int i = 0; i < lines; ++i)
+                        producer.append(std::to_string(p) + ":" + std::to_string(i) + "\n");
+                });
+            }
+            for (auto &t : threads) t.join();
+            appender.flush();
+        }
+        assert(log.starts_with(std::string("start\n")), "existing text is kept");
+        assert(log.resolve(anchor) == log.size(), "end anchor follows spliced text");
+
+        std::string flat(log.size(), '\0');
+        log.copy(flat.data(), flat.size());
+        std::vector<int> next(producers, 0);
+        std::size_t pos = 6;
+        while (pos < flat.size()) {
+            auto colon = flat.find(':', pos);
+            auto newline = flat.find('\n', colon);
+            int p = std::stoi(flat.substr(pos, colon - pos));
+            int i = std::stoi(flat.substr(colon + 1, newline - colon - 1));
+            assert(i == next[p]++, "producer lines stay in order");
+            pos = newline + 1;
+        }
+        for (auto n : next) assert(n == lines, "every line arrives");
+    }
+
+    // global sequence: appends ordered by a shared counter come out in that order
+    {
+        Test::String out;
+        Test::Appender appender(out, Rope::AppendOrder::Sequenced, 16);
+        std::atomic<int> turn = 0;
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                auto producer = appender.producer();
+                for (int i = p; i < lines; i += producers) {
+                    while (turn.load() != i) std::this_thread::yield();
+                    producer.push_back(static_cast<char>('a' + i % 26));
+                    turn.store(i + 1);
+                }
+            });
+        }
+        for (auto &t : threads) t.join();
+        appender.flush();
+
+        std::string expected;
+        for (int i = 0; i < lines; ++i) expected += static_cast<char>('a' + i % 26);
+        assert(out == expected, "sequenced appends follow ticket order");
+    }
+
+    // batches allocate like the target: with the default resource unusable nothing may fall back to it
+    for (auto order : {Rope::AppendOrder::PerProducer, Rope::AppendOrder::Sequenced}) {
+        std::pmr::monotonic_buffer_resource arena;
+        Test::pmr::String out("log:", &arena);
+        auto previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+        {
+            Rope::BasicAppender appender(out, order, 16);
+            auto producer = appender.producer();
+            for (int i = 0; i < 100; ++i) producer.append("0123456789");
+        }
+        std::pmr::set_default_resource(previous);
+        assert(out.size() == 4 + 1000 && out.ends_with("0123456789"), "appending with a memory resource");
+    }
+
+    // rvalue append moves roots
+    Test::String a("abc"), b("defgh");
+    a.append(std::move(b));
+    assert(a == "abcdefgh", "append rvalue string");
+}
@@ -0,0 +1,31 @@
+#include "lib.h"
+#include <vector>
+
+int main() {
+    Test::String s("int a = 1; int b = 2; int c = 3;");
+    auto after = s.anchor(s.size());
+
+    // replace-all of "int" given out of order, plus an insertion
+    std::vector<Test::String::Edit> edits {
+        {22, 3, "long"},
+        {0, 3, "long"},
+        {11, 3, "long"},
+        {10, 0, " //"},
+    };
+    s.apply(edits);
+    assert(s == "long a = 1; // long b = 2; long c = 3;", "batch applied against original offsets");
+    assert(s.resolve(after) == s.size(), "anchors follow the batch");
+
+    std::vector<Test::String::Edit> overlapping {
+        {0, 4, "x"},
+        {2, 1, "y"},
+    };
+    bool thrown = false;
+    try {
+        s.apply(overlapping);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown, "overlapping edits are rejected");
+    assert(s == "long a = 1; // long b = 2; long c = 3;", "rejected batch leaves the string untouched");
+}
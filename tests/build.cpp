@@ -0,0 +1,28 @@
+#include "lib.h"
+#include <execution>
+
+int main() {
+    std::string flat;
+    for (int i = 0; i < 4003; ++i)
+        flat += static_cast<char>('a' + i % 26);
+
+    auto s = Test::String::from_buffer(flat);
+    assert(s.size() == flat.size(), "from_buffer size");
+    assert(s == flat, "from_buffer content");
+    assert(s.data().getRoots().size() == (flat.size() + Test::Chunks::root_size - 1) / Test::Chunks::root_size, "roots are filled completely");
+
+    auto p = Test::String::from_buffer(Rope::ThreadExecutor(4), flat);
+    assert(p == flat, "parallel from_buffer with executor");
+    auto q = Test::String::from_buffer(std::execution::par, std::span<const char>(flat.data(), 7));
+    assert(q == flat.substr(0, 7), "parallel from_buffer with policy");
+    assert(Test::String::from_buffer(std::string_view()).empty(), "from_buffer of nothing");
+
+    // built ropes take regular edits
+    p.insert(5, "XYZ");
+    p.erase(100, 50);
+    p.push_back('!');
+    flat.insert(5, "XYZ");
+    flat.erase(100, 50);
+    flat.push_back('!');
+    assert(p == flat, "edits after from_buffer");
+}
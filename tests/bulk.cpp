@@ -0,0 +1,53 @@
+#include "lib.h"
+#include <forward_list>
+#include <list>
+#include <sstream>
+#include <iterator>
+
+int main() {
+    Test::String s("0123456789");
+    std::string expected = "0123456789";
+
+    s.insert(4, 7, 'x');
+    expected.insert(4, 7, 'x');
+    assert(s == expected.c_str(), "fill insert in the middle");
+    std::size_t leaves = 0;
+    for (auto &root : s.data().getRoots())
+        for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) ++leaves;
+    assert(leaves <= (expected.size() + Test::Chunks::leaf_size - 1) / Test::Chunks::leaf_size + 2, "fill insert builds full leaves");
+
+    std::vector<char> contiguous {'a', 'b', 'c', 'd', 'e'};
+    s.insert(s.cbegin(), contiguous.begin(), contiguous.end());
+    expected.insert(0, "abcde");
+    assert(s == expected.c_str(), "contiguous range insert");
+
+    std::list<char> list {'L', 'M', 'N'};
+    s.insert(Test::String::const_iterator(s.data(), 9), list.begin(), list.end());
+    expected.insert(9, "LMN");
+    assert(s == expected.c_str(), "bidirectional range insert");
+
+    std::istringstream in("streamed");
+    s.insert(Test::String::const_iterator(s.data(), s.size()), std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    expected += "streamed";
+    assert(s == expected.c_str(), "single pass range insert");
+
+    std::forward_list<int> codes {'1', '2'};
+    s.append(codes.begin(), codes.end());
+    s.append(3, '#');
+    expected += "12###";
+    assert(s == expected.c_str(), "append ranges and fill");
+
+    Test::String copy(s);
+    auto before = expected;
+    s.insert(2, copy);
+    expected.insert(2, before);
+    assert(s == expected.c_str(), "insert another rope");
+    assert(copy == before.c_str(), "inserted rope unchanged");
+    s.insert(0, s);
+    expected.insert(0, expected);
+    assert(s == expected.c_str(), "insert into itself");
+
+    std::string word = "range";
+    Test::String built(word.begin(), word.end());
+    assert(built == "range", "iterator range constructor");
+}
@@ -0,0 +1,77 @@
+#include "lib.h"
+#include <sstream>
+
+static auto leaves(const Test::String &s) -> std::size_t {
+    std::size_t count = 0;
+    for (auto &root : s.data().getRoots())
+        for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) ++count;
+    return count;
+}
+
+int main() {
+    // one character inserts in the middle leave half empty leaves behind
+    Test::String s("0123456789abcdefghij");
+    std::string expected = "0123456789abcdefghij";
+    for (int i = 0; i < 40; ++i) {
+        s.insert(5 + i % 7, "x");
+        expected.insert(5 + i % 7, "x");
+    }
+    s.erase(20, 15);
+    expected.erase(20, 15);
+    // erase removes the roots it empties, thinning out the front still leaves fragmented roots
+    for (std::size_t i = 2; i < 14; ++i) {
+        s.erase(i, 2);
+        expected.erase(i, 2);
+    }
+    auto anchor = s.anchor(15, Rope::Gravity::Left);
+    auto end = s.anchor(s.size());
+    auto before = leaves(s);
+
+    s.compact();
+    assert(s == expected.c_str(), "compact keeps content");
+    assert(leaves(s) < before, "compact merges leaves");
+    for (auto &root : s.data().getRoots()) {
+        std::size_t count = 0;
+        for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) ++count;
+        assert(root.second && root.second <= Test::Chunks::root_size && root.second >= 0.5 * count * Test::Chunks::leaf_size,
+               "fragmented roots are repacked, no root is left empty, oversized or below min_fill");
+    }
+    assert(s.resolve(anchor) == 15 && s.resolve(end) == s.size(), "compact keeps anchors");
+    s.insert(15, "AB");
+    expected.insert(15, "AB");
+    assert(s == expected.c_str() && s.resolve(anchor) == 15, "edits after compact");
+
+    // emptied roots are dropped
+    Test::String t("abcdefghijklmnopqrstuvwxyz");
+    t.erase(3, 15);
+    t.shrink_to_fit();
+    assert(t == "abcstuvwxyz", "shrink_to_fit keeps content");
+    for (auto &root : t.data().getRoots())
+        assert(root.second != 0, "no empty roots after shrink_to_fit");
+
+    // automatic policy keeps every edited root above the threshold
+    Test::String a("0123456789abcdefghij");
+    a.set_compact_policy({.min_fill = 0.75, .automatic = true});
+    expected = "0123456789abcdefghij";
+    for (int i = 0; i < 40; ++i) {
+        a.insert(3 + i % 11, "y");
+        expected.insert(3 + i % 11, "y");
+    }
+    assert(a == expected.c_str(), "automatic compaction keeps content");
+    for (auto &root : a.data().getRoots()) {
+        std::size_t count = 0;
+        for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) ++count;
+        assert(root.second >= 0.75 * count * Test::Chunks::leaf_size, "edited roots stay above min_fill");
+    }
+
+    // the automatic policy cuts an edited root holding more than root_size characters, like compact()
+    using Wider = Rope::BasicString<char, std::char_traits<char>, std::allocator<char>, Rope::ChunkPolicy<2, 8>>;
+    std::stringstream image;
+    Wider("0123456789abcdef").serialize(image);
+    auto loaded = Test::String::deserialize(image); // roots of 8 fit within a leaf of slack, they are kept
+    assert(loaded.data().getRoots().front().second == 8, "a loaded root past root_size");
+    loaded.set_compact_policy({.min_fill = 0.5, .automatic = true});
+    loaded.erase(2, 1);
+    assert(loaded == "013456789abcdef", "automatic cut keeps content");
+    assert(loaded.data().getRoots().size() == 3 && loaded.data().getRoots().front().second <= Test::Chunks::root_size, "the edited root is cut");
+}
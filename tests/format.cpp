@@ -0,0 +1,43 @@
+#include "lib.h"
+#include <cstdio>
+#include <sstream>
+
+int main() {
+    // the formatter writes the pieces for_each_chunk hands out
+    Test::String s("a rope spread over leaves");
+    std::string pieces;
+    std::size_t calls = 0;
+    s.for_each_chunk([&](std::string_view chunk) { pieces += chunk; ++calls; }, 2, 11);
+    assert(pieces == "rope spread" && calls > 1, "for_each_chunk views leaves in place");
+    pieces.clear();
+    Rope::BasicString<char, std::char_traits<char>, std::allocator<char>, Rope::ChunkPolicy<2, 6, 2>>("ab").for_each_chunk([&](std::string_view chunk) { pieces += chunk; });
+    assert(pieces == "ab", "for_each_chunk of an inline string");
+
+#ifdef __cpp_lib_format
+    assert(std::format("{}", s) == "a rope spread over leaves", "plain");
+    assert(std::format("[{:30}]", s) == "[a rope spread over leaves     ]", "width, left by default");
+    assert(std::format("[{:>30}]", s) == "[     a rope spread over leaves]", "right alignment");
+    assert(std::format("[{:*^31}]", s) == "[***a rope spread over leaves***]", "fill and center");
+    assert(std::format("[{:.6}]", s) == "[a rope]", "precision truncates");
+    assert(std::format("[{:-<{}.{}}]", s, 8, 4) == "[a ro----]", "dynamic width and precision");
+    assert(std::format("[{0:>{1}}]", s, 27) == "[  a rope spread over leaves]", "indexed arguments");
+    assert(std::format(L"{:>4}", Test::WString(L"ab")) == L"  ab", "wide strings");
+    bool thrown = false;
+    try { (void)std::vformat("{:d}", std::make_format_args(s)); } catch (const std::format_error&) { thrown = true; }
+    assert(thrown, "integer presentation is rejected");
+
+    std::ostringstream out;
+    Rope::println(out, "{}!", s);
+    assert(out.str() == "a rope spread over leaves!\n", "println into a stream");
+
+    // printing into a FILE* spans several blocks of the writer
+    Test::String large(std::string(10000, 'x') + "end");
+    auto file = std::tmpfile();
+    Rope::println(file, "[{}]", large);
+    std::rewind(file);
+    std::string read(large.size() + 3, '\0');
+    assert(std::fread(read.data(), 1, read.size(), file) == read.size() && std::fgetc(file) == EOF, "everything is written once");
+    std::fclose(file);
+    assert(read == "[" + large.to_string() + "]\n", "println into a FILE*");
+#endif
+}
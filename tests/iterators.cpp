@@ -2,7 +2,7 @@
 
 int main() {
     const char* cstr = "0123456789";
-    Rope::String str(cstr);
+    Test::String str(cstr);
     std::size_t count = 0;
     for (const auto c : str) {
         assert(c == cstr[count++], "c == cstr[count++]");
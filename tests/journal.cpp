@@ -0,0 +1,32 @@
+#include "lib.h"
+
+int main() {
+    Test::String s("hello world");
+    auto &journal = s.enable_journal();
+    auto cursor = journal.subscribe();
+
+    s.insert(5, ",");
+    s.push_back('!');
+    s.erase(0, 1);
+    assert(journal.pending(cursor) == 3, "three edits recorded");
+
+    auto dirty = journal.pull(cursor);
+    assert(s == "ello, world!", "edits applied");
+    assert(dirty.size() == 3, "disjoint edits stay separate");
+    assert((dirty[0] == Rope::Change{0, 1, 0}), "erase at start");
+    assert((dirty[1] == Rope::Change{4, 0, 1}), "comma insert in current coordinates");
+    assert((dirty[2] == Rope::Change{11, 0, 1}), "push_back at end");
+    assert(journal.pending(cursor) == 0, "pull advances the cursor");
+
+    s.replace(0, 4, "HELLO");
+    s.insert(5, "!!");
+    dirty = journal.pull(cursor);
+    assert(dirty.size() == 1, "touching edits coalesce");
+    assert((dirty[0] == Rope::Change{0, 4, 7}), "coalesced range covers both edits");
+
+    s.resize(3);
+    s.resize_and_overwrite(2, [](char *p, std::size_t n) { p[0] = 'h'; return n; });
+    dirty = journal.pull(cursor);
+    assert(s == "hE", "resize and overwrite applied");
+    assert(dirty.size() == 1 && (dirty[0] == Rope::Change{0, 15, 2}), "resize paths are recorded");
+}
@@ -1,13 +1,34 @@
 #ifndef ROPE_LIB_H
 #define ROPE_LIB_H
 
-#define ROPE_STRING_MAX_ROOT_SIZE 6 // fragmentation between root nodes in Tree
-#define ROPE_STRING_MAX_LEAF_SIZE 2 // fragmentation between string value in node
-
 #include <iostream>
 #include <string>
 #include <source_location>
 #include <RopeString.h>
+
+/*
+ * The tests run on tiny chunks so every edit crosses leaf and root boundaries. They use an explicit
+ * policy instead of redefining ROPE_STRING_MAX_LEAF_SIZE / ROPE_STRING_MAX_ROOT_SIZE, so Rope::String
+ * keeps its default chunks here like in every other translation unit.
+ */
+namespace Test {
+    using Chunks = Rope::ChunkPolicy<2, 6>; // fragmentation between string values in leaves and between roots
+
+    template<typename CharT>
+    using BasicString = Rope::BasicString<CharT, std::char_traits<CharT>, std::allocator<CharT>, Chunks>;
+    using String = BasicString<char>;
+    using WString = BasicString<wchar_t>;
+    using StringView = Rope::BasicStringView<char, std::char_traits<char>, std::allocator<char>, Chunks>;
+    using SharedString = Rope::BasicSharedString<char, std::char_traits<char>, std::allocator<char>, Chunks>;
+    using Appender = Rope::BasicAppender<char, std::char_traits<char>, std::allocator<char>, Chunks>;
+    using RopeBuf = Rope::BasicRopeBuf<char, std::char_traits<char>, std::allocator<char>, Chunks>;
+    using IRopeStream = Rope::BasicIRopeStream<char, std::char_traits<char>, std::allocator<char>, Chunks>;
+    using ORopeStream = Rope::BasicORopeStream<char, std::char_traits<char>, std::allocator<char>, Chunks>;
+    namespace pmr {
+        using String = Rope::pmr::BasicString<char, std::char_traits<char>, Chunks>;
+    }
+}
+
 inline void assert(bool cond, const char* message, const std::source_location& loc = std::source_location::current()) {
     if (!cond) {
         std::string where = std::string(loc.file_name()) + ":" + std::to_string((int)loc.line());
@@ -15,4 +36,4 @@ inline void assert(bool cond, const char* message, const std::source_location& l
     }
 }
 
-#endif //ROPE_LIB_H
\ No newline at end of file
+#endif //ROPE_LIB_H
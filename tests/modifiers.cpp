@@ -1,7 +1,8 @@
 #include "lib.h"
+#include <random>
 
 int main() {
-    Rope::String s("hello, world");
+    Test::String s("hello, world");
     s.clear();
     assert(s.empty(), "s.empty()");
 
@@ -37,4 +38,53 @@ int main() {
     assert(s == "Hello, World! This is my Rope String", "append");
 
     s.replace(23, 2, "your");
-}
\ No newline at end of file
+
+    // char by char appends fill leaves instead of allocating one per character
+    Test::String t;
+    std::string expected;
+    for (int i = 0; i < 25; ++i) {
+        t.push_back(static_cast<char>('a' + i));
+        expected += static_cast<char>('a' + i);
+        assert(t.back() == expected.back(), "back after push_back");
+    }
+    assert(t == expected.c_str(), "push_back sequence");
+    std::size_t leaves = 0;
+    for (auto &root : t.data().getRoots())
+        for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) ++leaves;
+    assert(leaves == (expected.size() + Test::Chunks::leaf_size - 1) / Test::Chunks::leaf_size, "leaves are filled completely");
+    for (int i = 0; i < 10; ++i) {
+        t.pop_back();
+        expected.pop_back();
+        assert(t.back() == expected.back(), "back after pop_back");
+    }
+    t.append(std::span<const char>("xyz", 3));
+    t += std::string_view("uv");
+    expected += "xyzuv";
+    assert(t == expected.c_str(), "append span and view after pop_back");
+
+    // a long typing session at random positions keeps roots bounded and leaves filled
+    using Typed = Rope::BasicString<char, std::char_traits<char>, std::allocator<char>, Rope::ChunkPolicy<16, 64>>;
+    Typed typed;
+    std::string model;
+    std::mt19937 random(3);
+    for (int i = 0; i < 20000; ++i) {
+        if (!model.empty() && random() % 10 == 0) {
+            auto at = random() % model.size();
+            typed.erase(at, 1);
+            model.erase(at, 1);
+        } else {
+            auto at = random() % (model.size() + 1);
+            typed.insert(at, "k");
+            model.insert(at, "k");
+        }
+    }
+    assert(typed == model.c_str(), "typing session keeps content");
+    std::size_t typed_roots = 0, typed_leaves = 0;
+    for (auto &root : typed.data().getRoots()) {
+        assert(root.second <= Typed::max_root_size, "inserts never grow a root past max_root_size");
+        ++typed_roots;
+        for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get()) ++typed_leaves;
+    }
+    assert(typed_roots <= 4 * model.size() / Typed::max_root_size, "roots stay at least a quarter full");
+    assert(typed_leaves <= 4 * model.size() / Typed::max_leaf_size, "leaves stay a quarter full on average");
+}
@@ -2,38 +2,47 @@
 
 int main() {
     // copy
-    Rope::String s("Hello, Rope");
+    Test::String s("Hello, Rope");
     char buf[64]{};
     auto copied = s.copy(buf, 5, 7); // copy "Rope" (4) + maybe comma? Actually from pos7, 5 chars => "Rope"
     assert(copied == 5 || copied == 4, "copy count tolerant"); // fragmentation may affect available
 
     // resize shrink
-    Rope::String a("abc");
+    Test::String a("abc");
     a.resize(2);
     assert(a == "ab", "resize shrink");
 
     // resize_and_overwrite: uppercase first letters and set length
-    Rope::String b("hello world");
+    Test::String b("hello world");
     b.resize_and_overwrite(11, [](char* p, std::size_t n){
         for (std::size_t i = 0; i < n; ++i) p[i] = (i < 5 ? (char)std::toupper((unsigned char)"hello"[i]) : (i==5?' ':"world"[i-6]));
         return (std::size_t)11;
     });
     assert(b == "HELLO world", "resize_and_overwrite");
 
+    // substr, and a writable buffer with a count is a pointer and length, not a view and a position
+    assert(s.substr(7, 4) == "Rope" && s.substr(0, 5).size() == 5, "substr");
+    char text[] = "abcdef";
+    Test::String from_buffer;
+    from_buffer.assign(text, 4);
+    from_buffer.append(text, 2);
+    from_buffer.insert(0, text, 1);
+    assert(from_buffer == "aabcdab", "pointer and count overloads");
+
     // swap
-    Rope::String x("left");
-    Rope::String y("right");
+    Test::String x("left");
+    Test::String y("right");
     x.swap(y);
     assert(x == "right" && y == "left", "swap");
 
     // compare
-    Rope::String c1("abc");
-    Rope::String c2("abd");
+    Test::String c1("abc");
+    Test::String c2("abd");
     assert(c1.compare(c2) < 0, "compare bs");
     assert(c2.compare("abd") == 0, "compare cstr eq");
 
     // starts_with / ends_with / contains
-    Rope::String t("prefix-body-suffix");
+    Test::String t("prefix-body-suffix");
     assert(t.starts_with('p'), "starts_with char");
     assert(t.rfind("suffix") == t.size() - 6, "suffix via rfind");
     assert(t.contains('-'), "contains char");
@@ -0,0 +1,41 @@
+#include "lib.h"
+#include <execution>
+
+int main() {
+    // enough roots for several parallel runs, with matches placed across root and run boundaries
+    std::string flat;
+    for (int i = 0; i < 600000; ++i)
+        flat += static_cast<char>('a' + i % 7);
+    flat.replace(150000, 6, "needle");
+    flat[180000] = 'z';
+    Test::String s;
+    for (std::size_t i = 0; i < flat.size(); i += 5)
+        s.append(flat.substr(i, 5));
+
+    Rope::ThreadExecutor pool(4);
+    assert(s.find(pool, 'z') == flat.find('z'), "parallel find char");
+    assert(s.find(std::execution::par, 'z') == flat.find('z'), "parallel find char with policy");
+    assert(s.find(pool, 'z', 180001) == Test::String::npos, "parallel find char after last match");
+    assert(s.find(pool, 'c', 3) == flat.find('c', 3), "parallel find char from pos");
+    assert(s.find(pool, std::string("needle")) == 150000, "parallel find substring");
+    assert(s.find(std::execution::par, "dle") == 150003, "parallel find substring with policy");
+    assert(s.find(pool, std::string("gab")) == flat.find("gab"), "parallel find across leaves");
+
+    // the first run ends on the first root boundary past parallel_grain, at most a root size later
+    auto boundary = Test::String::parallel_grain - 6;
+    s.replace(boundary, 12, "XXYYZZXXYYZW");
+    flat.replace(boundary, 12, "XXYYZZXXYYZW");
+    assert(s.find(pool, "XXYYZZXXYYZW") == boundary, "parallel find match crossing runs");
+    assert(s.find_first_of(pool, std::string("YZ")) == flat.find_first_of("YZ"), "parallel find_first_of");
+
+    assert(s.count('a') == static_cast<std::size_t>(std::count(flat.begin(), flat.end(), 'a')), "count");
+    assert(s.count(pool, 'a') == s.count('a'), "parallel count");
+    assert(s.count(std::execution::par_unseq, 'e') == static_cast<std::size_t>(std::count(flat.begin(), flat.end(), 'e')), "parallel count with policy");
+
+    std::string out(flat.size(), '\0');
+    assert(s.copy(pool, out.data(), out.size()) == flat.size(), "parallel copy size");
+    assert(out == flat, "parallel copy content");
+    std::string part(10, '\0');
+    assert(s.copy(std::execution::par, part.data(), 10, boundary - 2) == 10, "parallel copy from pos");
+    assert(part == flat.substr(boundary - 2, 10), "parallel copy from pos content");
+}
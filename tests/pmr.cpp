@@ -0,0 +1,75 @@
+#include "lib.h"
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+
+static std::size_t allocations = 0;
+auto operator new(std::size_t size) -> void* {
+    ++allocations;
+    if (auto p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+// Counts what is allocated from it, on top of a monotonic buffer
+struct Counting : std::pmr::memory_resource {
+    std::pmr::monotonic_buffer_resource upstream;
+    std::size_t bytes = 0;
+    auto do_allocate(std::size_t size, std::size_t align) -> void* override {
+        bytes += size;
+        return upstream.allocate(size, align);
+    }
+    void do_deallocate(void *p, std::size_t size, std::size_t align) override { upstream.deallocate(p, size, align); }
+    auto do_is_equal(const std::pmr::memory_resource &other) const noexcept -> bool override { return this == &other; }
+};
+
+int main() {
+    static_assert(std::is_same_v<Test::pmr::String::allocator_type, std::pmr::polymorphic_allocator<char>>, "pmr alias");
+    Counting arena, other_arena;
+    {
+        auto before = allocations;
+        Test::pmr::String s("a string spread over many leaves and roots", &arena);
+        s.append(" and some more");
+        s.insert(2, "long ");
+        s.erase(0, 2);
+        s.replace(0, 4, "LONG");
+        Test::pmr::String shared(&arena);
+        shared = s;
+        s.push_back('!');
+        auto flat = s.c_str();
+        auto view = s.view();
+        assert(allocations == before && arena.bytes > 0, "every node, root list and buffer comes from the resource");
+        assert(view == "LONG string spread over many leaves and roots and some more!", "edits with a memory resource");
+        assert(shared == "LONG string spread over many leaves and roots and some more" && flat[0] == 'L', "copies share roots");
+
+        auto used = arena.bytes;
+        Test::pmr::String copied(&other_arena);
+        copied = s;
+        Test::pmr::String moved(&other_arena);
+        moved = std::move(shared);
+        assert(arena.bytes == used && other_arena.bytes > 0, "assigning across resources copies into the destination one");
+        s.erase(0, 5);
+        assert(copied == "LONG string spread over many leaves and roots and some more!" && moved.size() == 59, "copies into another resource are independent");
+        assert(s.get_allocator().resource() == &arena && copied.get_allocator().resource() == &other_arena, "allocators do not propagate");
+
+        Test::pmr::String escaped(s);
+        assert(escaped.get_allocator().resource() == std::pmr::get_default_resource(), "copy construction uses the default resource");
+    }
+    arena.upstream.release();
+
+    // appending a moved string from another resource copies its leaves, they outlive that resource
+    Counting target_arena, scratch;
+    Test::pmr::String target("the target lives on one resource", &target_arena);
+    {
+        Test::pmr::String part(" and the part on a scratch one", &scratch);
+        target.append(std::move(part));
+    }
+    scratch.upstream.release();
+    assert(target == "the target lives on one resource and the part on a scratch one", "spliced roots are cloned into the target resource");
+
+    std::allocator<char> plain;
+    Test::String standard("standard allocator", plain);
+    Test::String copy = standard;
+    assert(copy.get_allocator() == plain && copy == "standard allocator", "std::allocator is unaffected");
+}
@@ -0,0 +1,38 @@
+#include "lib.h"
+
+using Large = Rope::BasicString<char, std::char_traits<char>, std::allocator<char>, Rope::LargeChunks>;
+using Odd = Rope::BasicString<char, std::char_traits<char>, std::allocator<char>, Rope::ChunkPolicy<3, 9>>;
+
+static_assert(Rope::SizePolicy<Rope::SmallChunks> && Rope::SizePolicy<Rope::LargeChunks>);
+static_assert(!Rope::SizePolicy<Rope::ChunkPolicy<0, 4>> && !Rope::SizePolicy<Rope::ChunkPolicy<8, 4>>);
+static_assert(std::is_same_v<Rope::String::policy_type, Rope::DefaultChunks> && Rope::String::max_leaf_size == 128);
+static_assert(Test::String::max_leaf_size == Test::Chunks::leaf_size && Large::max_leaf_size == Rope::LargeChunks::leaf_size);
+
+template<typename S>
+auto edited() -> std::string {
+    S s("hello world, this is a rope with its own chunk sizes");
+    s.insert(5, ",");
+    s.erase(0, 1);
+    s.replace(0, 4, "HELL");
+    s.append(100, '!');
+    s.push_back('?');
+    std::string flat(s.size(), '\0');
+    s.copy(flat.data(), flat.size());
+    return flat;
+}
+
+int main() {
+    // ropes with different chunk sizes live side by side in one binary
+    auto expected = edited<Test::String>();
+    assert(edited<Large>() == expected, "large chunks give the same text");
+    assert(edited<Odd>() == expected, "odd chunks give the same text");
+
+    Test::String small(expected.c_str());
+    Large large(expected.c_str());
+    Odd odd(expected.c_str());
+    assert(small.stats().leaf_size == Test::Chunks::leaf_size && large.stats().leaf_size == Rope::LargeChunks::leaf_size, "stats report the policy");
+    assert(large.stats().leaves == 1 && large.data().getRoots().size() == 1, "one large leaf holds the whole text");
+    assert(odd.stats().leaves == (expected.size() + 2) / 3, "leaves follow the policy's leaf size");
+    assert(odd.data().getRoots().size() == (expected.size() + 8) / 9, "roots follow the policy's root size");
+    assert(odd.find("HELLO") == small.find("HELLO") && large.substr(4, 5) == small.substr(4, 5).c_str().get(), "reads agree");
+}
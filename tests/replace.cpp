@@ -0,0 +1,50 @@
+#include "lib.h"
+#include <string>
+
+// std::string reference: every occurrence from left to right, without overlaps
+static auto reference(std::string text, std::string_view pattern, std::string_view with) -> std::string {
+    for (auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + with.size()))
+        text.replace(pos, pattern.size(), with);
+    return text;
+}
+
+int main() {
+    // occurrences crossing leaves of 2 characters, on a string with uneven leaves
+    std::string text = "Hello ${name}, your order ${id} ships to ${name}${name} at ${";
+    Test::String s(text);
+    s.insert(5, "xyz");
+    s.erase(5, 3);
+    for (auto [pattern, with] : {std::pair<std::string_view, std::string_view>{"${name}", "Ada"}, {"$", "$$"}, {"e", ""},
+                                 {"${", "{"}, {"}", "} and a much longer replacement than the leaves"}, {"nothing", "x"}}) {
+        Test::String copy = s;
+        copy.replace_all(pattern, with);
+        assert(copy == reference(text, pattern, with), "replace every occurrence");
+    }
+    Test::String aaa("aaaaa");
+    assert(aaa.replace_all("aa", "b") == 2 && aaa == "bba", "no overlaps, counted");
+    assert(aaa.replace_all("", "x") == 0 && aaa == "bba", "an empty pattern matches nothing");
+
+    // a callback computes each replacement from the position in the unchanged string
+    Test::String tpl("a=${}, b=${}, c=${}");
+    int next = 0;
+    tpl.replace_all("${}", [&](std::size_t pos) {
+        assert(tpl.substr(pos, 3) == "${}", "the callback sees the string unchanged");
+        return std::to_string(++next * 10);
+    });
+    assert(tpl == "a=10, b=20, c=30", "replacements from a callback");
+
+    // the replacement may view the string itself
+    Test::String self("ab-ab-ab");
+    self.replace_all("-", self.view().substr(0, 2));
+    assert(self == "ababababab", "replacement viewing the string");
+
+    // roots without an occurrence are reused, anchors follow the edits
+    std::string big(600, '.');
+    big.replace(10, 3, "{x}");
+    Test::String large(big);
+    Test::String before = large;
+    auto end = large.anchor(large.size());
+    assert(large.replace_all("{x}", "value") == 1 && large == reference(big, "{x}", "value"), "replace in a large string");
+    assert(large.data().getRoots().back().first == before.data().getRoots().back().first, "untouched roots are shared");
+    assert(large.resolve(end) == large.size(), "anchors follow replace_all");
+}
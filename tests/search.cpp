@@ -1,12 +1,12 @@
 #include "lib.h"
 
 int main() {
-    Rope::String s("hello world, hello rope");
+    Test::String s("hello world, hello rope");
 
     // find
     assert(s.find('h') == 0, "find char");
     assert(s.find("world") == 6, "find cstr");
-    Rope::String needle("hello");
+    Test::String needle("hello");
     assert(s.find(needle, 1) == 13, "find substring from pos");
 
     // rfind
@@ -19,7 +19,7 @@ int main() {
 
     // find_last_of / not_of
     assert(s.find_last_of("aeiou") == 22, "find_last_of vowel 'e' at end");
-    assert(s.find_last_not_of(" ehlorwpd,") == Rope::String::npos, "all are in the set");
+    assert(s.find_last_not_of(" ehlorwpd,") == Test::String::npos, "all are in the set");
 
     // contains
     assert(s.contains('r'), "contains char r");
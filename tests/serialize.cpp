@@ -0,0 +1,75 @@
+#include "lib.h"
+#include <cstdio>
+#include <execution>
+#include <sstream>
+
+// Sizes of the non-empty leaves, a 0 ends each root that has any
+static auto layout(const Test::String &s) -> std::vector<std::size_t> {
+    std::vector<std::size_t> leaves;
+    for (auto &root : s.data().getRoots()) {
+        if (root.second == 0) continue;
+        for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get())
+            if (!leaf->str.empty()) leaves.push_back(leaf->str.size());
+        leaves.push_back(0);
+    }
+    return leaves;
+}
+
+int main() {
+    Test::String s = Test::String::from_buffer(std::span<const char>(std::string_view("a rope saved with its chunks")));
+    s.insert(5, "x");
+    s.erase(10, 3);
+
+    std::stringstream stream;
+    s.serialize(stream);
+    auto bytes = stream.str();
+    Rope::SerialHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    assert(header.characters == s.size() && header.payload_offset % Rope::serial_alignment == 0, "header");
+    assert(bytes.size() == header.payload_offset + s.size(), "tables, padding and payload");
+
+    auto loaded = Test::String::deserialize(stream);
+    assert(loaded == s && layout(loaded) == layout(s), "the chunk layout survives a round trip");
+
+    std::stringstream checked;
+    s.serialize(checked, {.checksums = true});
+    auto image = checked.str();
+    auto mapped = std::as_bytes(std::span(image));
+    assert(Test::String::deserialize(mapped) == s, "load from a mapped image");
+    assert(Test::String::deserialize(std::execution::par, mapped) == s, "parallel load from a mapped image");
+
+    image[image.size() - 2] ^= 1;
+    bool caught = false;
+    try { Test::String::deserialize(std::as_bytes(std::span(image))); } catch (const std::runtime_error&) { caught = true; }
+    assert(caught, "a corrupt leaf fails its checksum");
+    caught = false;
+    try { Test::String::deserialize(std::as_bytes(std::span(image).first(image.size() - 5))); } catch (const std::runtime_error&) { caught = true; }
+    assert(caught, "a truncated image is rejected");
+    caught = false;
+    std::stringstream garbage("not a rope at all, just some text that is long enough for a header.......");
+    try { Test::String::deserialize(garbage); } catch (const std::runtime_error&) { caught = true; }
+    assert(caught, "a foreign file is rejected");
+
+    // written with larger chunks: roots that do not fit are re-chunked on load
+    using Large = Rope::BasicString<char, std::char_traits<char>, std::allocator<char>, Rope::ChunkPolicy<8, 32>>;
+    Large large("a longer text written with larger leaves and roots than the reader uses");
+    std::stringstream across;
+    large.serialize(across);
+    auto narrow = Test::String::deserialize(across);
+    assert(narrow == "a longer text written with larger leaves and roots than the reader uses", "load across chunk sizes");
+    for (auto size : layout(narrow)) assert(size <= Test::String::max_leaf_size, "leaves fit the reader");
+    narrow.insert(3, "!");
+    assert(narrow.substr(0, 6) == "a l!on", "edits after a load across chunk sizes");
+
+    std::stringstream empty;
+    Test::String().serialize(empty);
+    assert(Test::String::deserialize(empty).empty(), "an empty rope");
+
+#ifdef ROPE_SERIAL_FD
+    auto file = std::tmpfile();
+    s.serialize(fileno(file));
+    std::rewind(file);
+    assert(Test::String::deserialize(fileno(file)) == s, "round trip through a file descriptor");
+    std::fclose(file);
+#endif
+}
@@ -0,0 +1,46 @@
+#include "lib.h"
+#include <atomic>
+#include <thread>
+
+int main() {
+    Test::SharedString shared(Test::String("abc"));
+    auto reader = shared.reader();
+
+    auto before = reader.snapshot();
+    shared.writer().append("def");
+    shared.writer().insert(0, "_");
+    assert(reader.read()->size() == 3, "edits are invisible until published");
+    shared.publish();
+    assert(*reader.read() == "_abcdef", "published version is visible");
+    assert(before == "abc", "older snapshot is unchanged by later edits");
+
+    {
+        auto guard = reader.read();
+        shared.writer().erase(0, 1);
+        shared.publish();
+        assert(shared.pending() == 1, "version in use is not freed");
+        assert(*guard == "_abcdef", "guarded version stays intact");
+    }
+    shared.publish();
+    assert(shared.pending() == 0, "released versions are reclaimed");
+
+    // one writer appending digits while a reader checks every version it sees is well-formed
+    std::atomic<bool> done = false;
+    std::thread worker([&] {
+        auto r = shared.reader();
+        while (!done) {
+            auto guard = r.read();
+            auto size = guard->size();
+            assert(size >= 6 && (size == 6 || guard->back() == '9'), "reader sees a consistent version");
+        }
+    });
+    for (int i = 0; i < 2000; ++i) {
+        shared.writer().append("0123456789");
+        shared.writer().pop_back();
+        shared.writer().push_back('9');
+        shared.publish();
+    }
+    done = true;
+    worker.join();
+    assert(reader.read()->size() == 6 + 2000 * 10, "final version has every append");
+}
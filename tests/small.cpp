@@ -0,0 +1,101 @@
+#include "lib.h"
+#include <cstdlib>
+#include <new>
+
+static std::size_t allocations = 0;
+auto operator new(std::size_t size) -> void* {
+    ++allocations;
+    if (auto p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+// up to 8 characters inline
+using Inline = Rope::BasicString<char, std::char_traits<char>, std::allocator<char>, Rope::ChunkPolicy<4, 16, 8>>;
+
+static auto contents(const Inline &s) -> std::string {
+    std::string out(s.size(), '\0');
+    s.copy(out.data(), out.size());
+    return out;
+}
+
+int main() {
+    static_assert(Inline::small_size == 8 && Test::String::small_size == Test::Chunks::leaf_size, "small_size of a policy");
+
+    auto before = allocations;
+    {
+        Inline a, b("short"), c(3, 'x');
+        a = "abc";
+        a.append("de");
+        a.insert(0, "<");
+        a.push_back('>');
+        a.replace(1, 3, "A");
+        a.erase(0, 1);
+        a.pop_back();
+        b.swap(a);
+        c = b;
+        assert(contents(a) == "short" && contents(b) == "Ade" && contents(c) == "Ade", "edits of short strings");
+        assert(a.view() == "short" && a[1] == 'h' && a.front() == 's' && a.back() == 't', "reads of short strings");
+    }
+    assert(allocations == before, "short strings never touch the heap");
+
+    Inline s("12345678");
+    auto inside = reinterpret_cast<const char*>(&s);
+    assert(s.view().data() >= inside && s.view().data() < inside + sizeof(s), "the text lives inside the object");
+    s.append("9");
+    assert(contents(s) == "123456789" && s.stats().characters == 9, "growing past small_size moves into a tree");
+    s.erase(2);
+    assert(contents(s) == "12", "shrinking keeps the text");
+    before = allocations;
+    s.append("ab");
+    s.erase(0, 1);
+    assert(contents(s) == "2ab" && allocations == before, "shrunk to half of small_size, back inline");
+
+    Inline between("123456789");
+    between.erase(6);
+    before = allocations;
+    between.shrink_to_fit();
+    between.push_back('x');
+    assert(contents(between) == "123456x" && allocations == before, "shrink_to_fit moves a string of up to small_size inline");
+
+    std::string walked;
+    for (auto ch : std::as_const(s)) walked += ch;
+    assert(walked == "2ab" && s == Inline("2ab"), "iterators and comparison see the inline text");
+
+    // iterating and comparing short strings builds no tree image
+    before = allocations;
+    Inline left("2ab"), right("2ab");
+    walked.clear();
+    for (auto it = left.rbegin(); it != left.rend(); ++it) walked += *it;
+    assert(left == right && left == "2ab" && left == std::string("2ab") && walked == "ba2" && allocations == before, "no allocation to iterate or compare");
+
+    // writing through front() and back() keeps iterators and views valid, later readers see the write
+    auto it = left.begin();
+    Rope::BasicStringView<char, std::char_traits<char>, std::allocator<char>, Rope::ChunkPolicy<4, 16, 8>> whole(left);
+    left.front();
+    left.back();
+    ++it;
+    assert(*it == 'a' && whole.to_string() == "2ab", "a non-const front() or back() is not a change");
+    left.front() = 'X';
+    left.back() = 'Y';
+    assert(*left.begin() == 'X' && *it == 'a' && left.data().size() == 3 && contents(left) == "XaY" && left == "XaY", "writes through front() and back()");
+    assert(Rope::BasicStringView<char, std::char_traits<char>, std::allocator<char>, Rope::ChunkPolicy<4, 16, 8>>(left).to_string() == "XaY", "a new view sees the write");
+
+    Inline anchored("0123456789");
+    auto mark = anchored.anchor(9);
+    anchored.erase(0, 8);
+    assert(contents(anchored) == "89" && anchored.resolve(mark) == 1, "a string with anchors stays a tree");
+
+    Inline self("abcd");
+    self.append(self.view());
+    self.insert(0, self.view());
+    assert(contents(self) == "abcdabcdabcdabcd", "appending a view of itself");
+
+    using Off = Rope::BasicString<char, std::char_traits<char>, std::allocator<char>, Rope::ChunkPolicy<4, 16, 0>>;
+    Off off("ab");
+    off.append("c");
+    off.erase(0, 3);
+    off.push_back('z');
+    assert(off.size() == 1 && off.front() == 'z', "small_size 0 keeps every string in a tree");
+}
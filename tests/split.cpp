@@ -0,0 +1,79 @@
+#include "lib.h"
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+static std::size_t allocations = 0;
+auto operator new(std::size_t size) -> void* {
+    ++allocations;
+    if (auto p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+// std::views::split semantics on a flat string
+static auto reference(std::string_view text, std::string_view delim, bool any) -> std::vector<std::string> {
+    std::vector<std::string> pieces;
+    if (text.empty()) return pieces;
+    std::size_t start = 0;
+    while (true) {
+        auto hit = any ? text.find_first_of(delim, start) : text.find(delim, start);
+        if (hit == std::string_view::npos) break;
+        pieces.emplace_back(text.substr(start, hit - start));
+        start = hit + (any ? 1 : delim.size());
+    }
+    pieces.emplace_back(text.substr(start));
+    return pieces;
+}
+
+template<typename Range>
+static auto collect(const Range &range) -> std::vector<std::string> {
+    std::vector<std::string> pieces;
+    for (auto piece : range) pieces.push_back(piece.to_string());
+    return pieces;
+}
+
+int main() {
+    static_assert(std::ranges::forward_range<decltype(Test::String().split(','))> && std::ranges::view<decltype(Test::String().lines())>);
+    static_assert(!std::is_reference_v<std::ranges::range_reference_t<decltype(Test::String().split(','))>>, "pieces are handed out by value");
+
+    // delimiters and pieces crossing leaves of 2 characters, on a string with uneven leaves
+    std::string text = "GET /a HTTP/1.1, Host: x,, Accept: */*,User-Agent: rope::split, ";
+    Test::String s(text);
+    s.insert(7, "xyz");
+    s.erase(7, 3);
+    for (std::string_view delim : {",", ", ", ": ", "::", "HTTP/1.1", "nothing", "x"}) {
+        assert(collect(s.split(delim)) == reference(text, delim, false), "split by a string");
+        assert(collect(Test::StringView(s, 4, 40).split(delim)) == reference(std::string_view(text).substr(4, 40), delim, false), "split a range");
+    }
+    assert(collect(s.split(',')) == reference(text, ",", false), "split by a character");
+    assert(collect(s.split_any(" ,:")) == reference(text, " ,:", true), "split_any");
+    assert(collect(Test::String("a,").split(',')) == std::vector<std::string>{"a", ""} && collect(Test::String().split(',')).empty(), "ends like std::views::split");
+    assert(collect(Test::String("abc").split("")) == std::vector<std::string>{"abc"}, "an empty delimiter never matches");
+
+    Test::String log("first\r\nsecond\n\nthird\r\nlast");
+    assert(collect(log.lines()) == std::vector<std::string>{"first", "second", "", "third", "last"}, "lines drop \\r\\n and \\n");
+    assert(collect(Test::String("a\nb\n").lines()) == std::vector<std::string>{"a", "b"}, "no empty line after the final line end");
+
+    // pieces are views: positions in the source, contiguous when inside one leaf
+    auto fields = s.split(',');
+    auto it = fields.begin();
+    assert((*it).position() == 0 && (*++it).position() == 16 && *it == " Host: x", "pieces know their place");
+    Test::String wide("ab,cd,ef");
+    auto first = wide.split(',').front();
+    assert(first.contiguous() == std::string_view("ab") && first.contiguous()->data() == &*wide.data().getRoots().front().first->str.data(), "a piece inside one leaf views it in place");
+
+    // walking the range allocates nothing
+    std::string big;
+    for (int i = 0; i < 200; ++i) big += "line number " + std::to_string(i) + "\n";
+    Test::String many(big);
+    std::size_t count = 0, characters = 0;
+    auto before = allocations;
+    for (auto line : many.lines()) {
+        ++count;
+        characters += line.size();
+    }
+    for (auto word : many.split(' ')) characters += word.empty();
+    assert(allocations == before && count == 200 && characters == big.size() - 200, "no allocation per piece");
+}
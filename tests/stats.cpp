@@ -0,0 +1,27 @@
+#include "lib.h"
+
+int main() {
+    Test::String empty;
+    auto e = empty.stats();
+    assert(e.roots == 1 && e.empty_roots == 1, "empty string has one empty root");
+    assert(e.leaves == 1 && e.empty_leaves == 1 && e.fill_histogram[0] == 1, "empty root counts as an empty leaf");
+    assert(e.characters == 0 && e.payload_bytes == 0, "no payload");
+
+    Test::String s("0123456789abcdefghijk");
+    auto st = s.stats();
+    assert(st.characters == s.size() && st.payload_bytes == s.size(), "payload matches size");
+    assert(st.roots == 4 && st.leaves == 11, "roots and leaves of a pushed string");
+    assert(st.fill_histogram[9] == 10 && st.fill_histogram[5] == 1, "full leaves and one half leaf");
+    assert(st.depth == 1 + Test::Chunks::root_size / Test::Chunks::leaf_size, "depth is the longest chain plus the roots vector");
+    assert(st.empty_leaves == 0 && st.empty_roots == 0, "no empty leaves");
+    assert(st.totalBytes() > st.payload_bytes && st.overheadBytes() == st.totalBytes() - st.payload_bytes, "overhead accounting");
+    assert(st.string_header_bytes == st.leaves * sizeof(std::string), "string headers");
+
+    s.erase(6, 6);
+    st = s.stats();
+    assert(st.roots == 3 && st.empty_roots == 0, "erase removes the roots it empties");
+    s.erase(12, 3);
+    st = s.stats();
+    assert(st.roots == 3 && st.empty_roots == 1, "an emptied last root stays");
+    assert(st.fillRatio() > 0 && st.fillRatio() <= 1, "fill ratio in range");
+}
@@ -0,0 +1,97 @@
+#include "lib.h"
+#include <sstream>
+
+using Rope4 = Rope::BasicString<char, std::char_traits<char>, std::allocator<char>, Rope::ChunkPolicy<4, 16, 0>>;
+using Out4 = Rope::BasicORopeStream<char, std::char_traits<char>, std::allocator<char>, Rope::ChunkPolicy<4, 16, 0>>;
+struct Buf4 : Rope::BasicRopeBuf<char, std::char_traits<char>, std::allocator<char>, Rope::ChunkPolicy<4, 16, 0>> {
+    using BasicRopeBuf::BasicRopeBuf;
+    auto reading() const -> const char* { return gptr(); }
+};
+
+static auto contents(const Rope4 &s) -> std::string {
+    std::string out(s.size(), '\0');
+    s.copy(out.data(), out.size());
+    return out;
+}
+
+int main() {
+    Test::String s;
+    {
+        Test::ORopeStream out(s);
+        out << "x = " << 42 << ", y = " << 1.5 << '\n';
+        out << "second line";
+        assert(out.tellp() == 27, "tellp counts pending output");
+    }
+    assert(s == "x = 42, y = 1.5\nsecond line", "writes reach the string on destruction");
+
+    Test::IRopeStream in(s);
+    std::string word;
+    int x = 0;
+    double y = 0;
+    in >> word >> word >> x;
+    in.ignore(6);
+    in >> y;
+    assert(word == "=" && x == 42 && y == 1.5, "formatted reads across leaves");
+    std::string line;
+    std::getline(in >> std::ws, line);
+    assert(line == "second line" && !std::getline(in, line), "getline to the end");
+    in.clear();
+    in.seekg(4);
+    in >> x;
+    assert(x == 42 && in.tellg() == 6, "seekg / tellg");
+    in.seekg(-4, std::ios_base::end);
+    assert(std::string(std::istreambuf_iterator<char>(in), {}) == "line", "seek from the end");
+
+    // putting back steps into the previous leaf, like std::stringbuf
+    Test::IRopeStream back(s);
+    char read[7];
+    back.read(read, 7);
+    back.unget();
+    back.unget();
+    assert(back.get() == '2', "unget twice across leaves");
+    back.putback('2');
+    assert(back.good() && back.get() == '2', "putback of the same character across leaves");
+    back.putback('x');
+    assert(back.bad(), "putback of another character fails on a read only source");
+    std::stringstream reference("x = 42, y = 1.5\nsecond line");
+    reference.read(read, 7);
+    reference.unget();
+    reference.unget();
+    assert(reference.get() == '2', "std::stringbuf agrees");
+
+    // full leaves are linked in as they are, the get area is the leaf itself
+    Rope4 r;
+    {
+        Out4 out(r);
+        out << "0123456789abcdef";
+        assert(contents(r) == "0123456789ab", "full leaves are appended on overflow, the rest is pending");
+        auto &tree = r.data();
+        for (auto &root : tree.getRoots())
+            for (auto leaf = root.first.get(); leaf; leaf = leaf->right.get())
+                assert(leaf->str.size() == 4 || leaf->str.empty(), "every appended leaf is full");
+        out << "ghijkl" << std::flush;
+    }
+    assert(contents(r) == "0123456789abcdefghijkl", "flush appends the partial leaf");
+    Buf4 buf(std::as_const(r));
+    auto first = r.data().getRoots().front().first.get();
+    while (first->str.empty()) first = first->right.get();
+    assert(buf.sgetc() == '0' && buf.in_avail() == 4 && buf.reading() == first->str.data(), "the get area is the first leaf in place");
+    char chunk[8];
+    assert(buf.sgetn(chunk, 6) == 6 && std::string_view(chunk, 6) == "012345", "reads continue into the next leaf");
+    assert(buf.pubseekoff(0, std::ios_base::cur, std::ios_base::in) == 6, "position after a read");
+    assert(buf.pubseekpos(100, std::ios_base::in) == -1, "seek past the end fails");
+
+    // reading and writing the same string
+    Test::String both("ab");
+    Test::RopeBuf rw(both);
+    assert(rw.sbumpc() == 'a', "read");
+    rw.sputn("cdefgh", 6);
+    rw.pubsync();
+    assert(both == "abcdefgh" && rw.sbumpc() == 'b' && rw.sbumpc() == 'c', "reads keep their place across writes");
+
+    Test::String empty;
+    Test::IRopeStream none(empty);
+    assert(none.get() == std::char_traits<char>::eof(), "an empty string is at its end");
+    Test::RopeBuf read_only(std::as_const(s));
+    assert(read_only.sputc('x') == std::char_traits<char>::eof() && s.size() == 27, "a read-only buffer does not write");
+}
@@ -0,0 +1,89 @@
+#include "lib.h"
+
+static auto sign(int value) -> int { return (value > 0) - (value < 0); }
+
+int main() {
+    std::string text = "the quick brown fox jumps over the lazy dog, the end";
+    Test::String s(text);
+    std::string_view flat(text);
+
+    // every range against std::string_view
+    for (std::size_t pos = 0; pos <= text.size(); pos += 3) {
+        for (std::size_t count : {0ul, 1ul, 2ul, 5ul, 17ul, Test::String::npos}) {
+            Test::StringView view(s, pos, count);
+            auto expected = flat.substr(pos, count);
+            assert(view.size() == expected.size() && view.position() == pos, "size of a range");
+            assert(view == expected && view.to_string() == expected, "content of a range");
+            assert(view.compare(expected) == 0 && view.compare(std::string_view("the")) == sign(expected.compare("the")), "compare");
+            std::string walked;
+            for (auto ch : view) walked += ch;
+            assert(walked == expected, "iteration stays in the range");
+            for (std::string_view needle : {"the", "o", "e l", "fox jumps", "", "zz"}) {
+                assert(view.find(needle) == expected.find(needle), "find across leaves");
+                assert(view.find(needle, 4) == expected.find(needle, 4), "find from a position");
+                assert(view.rfind(needle) == expected.rfind(needle), "rfind");
+                assert(view.rfind(needle, 7) == expected.rfind(needle, 7), "rfind before a position");
+            }
+            assert(view.find('o', 2) == expected.find('o', 2) && view.rfind('e') == expected.rfind('e'), "find a character");
+            assert(view.find_first_of(" ,") == expected.find_first_of(" ,"), "find_first_of");
+            assert(view.find_first_not_of("the ") == expected.find_first_not_of("the "), "find_first_not_of");
+            if (!expected.empty()) {
+                assert(view.front() == expected.front() && view.back() == expected.back() && view[expected.size() / 2] == expected[expected.size() / 2], "element access");
+                assert(view.starts_with(expected.substr(0, 3)) && view.ends_with(expected.substr(expected.size() / 2)), "starts_with / ends_with");
+            }
+        }
+    }
+
+    Test::StringView view(s, 4, 15);
+    assert(view == "quick brown fox" && view.count('o') == 2 && view.contains("brown") && !view.contains("dog"), "a range");
+    auto inner = view.substr(6, 5);
+    assert(inner == "brown" && inner.position() == 10 && inner.substr(1).substr(1) == "own", "substr of a view stays a view");
+    char buffer[8] {};
+    assert(view.copy(buffer, 8, 10) == 5 && std::string_view(buffer, 5) == "n fox", "copy stops at the end of the view");
+    std::string chunks;
+    std::size_t calls = 0;
+    view.for_each_chunk([&](std::string_view piece) { chunks += piece; ++calls; }, 1, 9);
+    assert(chunks == "uick brow" && calls > 1, "chunks view the leaves in place");
+    assert(!view.contiguous() && Test::StringView(s, 4, 2).contiguous() == std::string_view("qu"), "a range inside one leaf is contiguous");
+    assert(Test::StringView(s, 5, 0).contiguous() == std::string_view(), "an empty range is contiguous");
+
+    assert(Test::StringView(s, 4, 5).compare(Test::StringView(s, 35, 4)) > 0, "views compare leaf by leaf");
+    assert(Test::StringView(s, 0, 3) == Test::StringView(s, 31, 3) && Test::StringView(s, 0, 4) != Test::StringView(s, 31, 3), "equal ranges at different offsets");
+    assert(Test::StringView(s).compare(Test::StringView(s, 0, 10)) > 0 && Test::StringView(s, 0, 10).compare(s) < 0, "a prefix compares less");
+
+    bool thrown = false;
+    try { Test::StringView(s, text.size() + 1); } catch (const std::out_of_range&) { thrown = true; }
+    assert(thrown, "a start past the end throws");
+
+    // ranges over edited trees with uneven and emptied leaves
+    Test::String edited(text);
+    std::string model = text;
+    for (std::size_t i = 0; i < 40; ++i) {
+        auto at = (i * 7) % model.size();
+        if (i % 3 == 0) {
+            edited.erase(at, 3);
+            model.erase(at, 3);
+        } else {
+            edited.insert(at, "ab");
+            model.insert(at, "ab");
+        }
+        Test::StringView range(edited, at / 2, 20);
+        auto expected = std::string_view(model).substr(at / 2, 20);
+        assert(range == expected && range.find("ab") == expected.find("ab") && range.substr(3, 9) == expected.substr(3, 9), "ranges of an edited string");
+    }
+
+    // views starting in every root, with emptied roots in between
+    std::string holes_model = "0123456789abcdefghijklmnopqrstuvwxyzABCDEF";
+    Test::String holes(holes_model);
+    holes.erase(6, 6);
+    holes.erase(12, 6);
+    holes_model.erase(6, 6);
+    holes_model.erase(12, 6);
+    for (std::size_t at = 0; at <= holes_model.size(); ++at)
+        assert(Test::StringView(holes, at, 5) == std::string_view(holes_model).substr(at, 5), "views skip emptied roots");
+
+    Test::String small("ab");
+    assert(Test::StringView(small, 1) == "b", "a view of a short string");
+    Test::StringView empty;
+    assert(empty.empty() && empty.find('a') == Test::String::npos && empty == "", "a default view is empty");
+}
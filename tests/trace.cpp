@@ -0,0 +1,52 @@
+#define ROPE_STRING_TRACE
+#include "lib.h"
+
+using Rope::trace::Op;
+
+static std::size_t exported = 0;
+static void sink(Op, std::size_t, std::uint64_t) { ++exported; }
+
+int main() {
+    auto &registry = Rope::trace::registry();
+    registry.reset();
+
+    Test::String s;
+    s.append("0123456789");
+    s.push_back('x');
+    auto push = registry.counters(Op::Push);
+    assert(push.calls == 2 && push.bytes == 11, "push calls and bytes");
+    std::uint64_t timed = 0;
+    for (auto bucket : push.latency) timed += bucket;
+    assert(timed == push.calls, "every push lands in the latency histogram");
+    assert(registry.counters(Op::LeafAlloc).calls >= s.size() / Test::Chunks::leaf_size, "leaf allocations counted");
+
+    s.insert(3, "abc");
+    s.erase(0, 2);
+    s.replace(0, 1, "zz");
+    assert(registry.counters(Op::Insert).calls == 1 && registry.counters(Op::Insert).bytes == 3, "insert traced");
+    assert(registry.counters(Op::Erase).calls == 1 && registry.counters(Op::Erase).bytes == 2, "erase traced");
+    assert(registry.counters(Op::Replace).calls == 1, "replace traced");
+
+    registry.reset();
+    s.find('x');
+    (void)s.c_str();
+    char buf[4];
+    s.copy(buf, 4);
+    assert(registry.counters(Op::Find).calls == 1 && registry.counters(Op::CStr).calls == 1, "find and c_str traced");
+    assert(registry.counters(Op::Copy).calls == 1 && registry.counters(Op::Copy).bytes == 4, "copy traced");
+    assert(registry.counters(Op::Flatten).calls == 0, "no flattening so far");
+
+    (void)s.substr(1, 2);
+    s.find(std::string("zz"));
+    s.rfind(std::string("zz"));
+    auto flatten = registry.counters(Op::Flatten);
+    assert(flatten.calls == 1 && flatten.bytes == s.size(), "flat copies counted separately, the cached one only once");
+    assert(registry.counters(Op::LeafAlloc).latency[0] == 0, "allocations carry no latency");
+
+    registry.setSink(sink);
+    s.push_back('y');
+    registry.setSink(nullptr);
+    s.push_back('z');
+    assert(exported > 0, "sink receives events");
+    assert(Rope::trace::name(Op::Flatten) == "flatten", "op names");
+}
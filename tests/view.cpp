@@ -0,0 +1,35 @@
+#include "lib.h"
+
+int main() {
+    Test::String s("0123456789abcdefghij");
+    auto v = s.view();
+    assert(v == "0123456789abcdefghij", "view shows the whole text");
+    assert(s.view().data() == v.data(), "an unchanged rope reuses its flat copy");
+
+    const Test::String copy = s;
+    assert(copy.view() == v, "copies view the same text");
+
+    s.insert(10, "-");
+    auto after = s.view();
+    assert(after == "0123456789-abcdefghij", "a mutation invalidates the copy");
+    s.back() = 'J';
+    assert(s.view() == "0123456789-abcdefghiJ", "writes through references invalidate too");
+    s.swap(const_cast<Test::String&>(copy));
+    assert(s.view() == "0123456789abcdefghij" && copy.view() == "0123456789-abcdefghiJ", "swap invalidates both");
+
+    std::string out = "> ";
+    s.append_to(out);
+    assert(out == "> 0123456789abcdefghij" && s.to_string() == "0123456789abcdefghij", "to_string and append_to");
+    assert(Test::String().view().empty() && Test::String().to_string().empty(), "empty rope");
+
+    // a small rope spread over several leaves collapses into one and is viewed in place
+    Test::String small("abcd");
+    small.erase(1, 2);
+    auto anchor = small.anchor(1);
+    assert(!small.data().contiguous(), "erase left two leaves");
+    auto flat = small.flatten();
+    assert(flat == "ad" && small.data().contiguous() && flat.data() == small.data().contiguous()->data(), "flatten collapsed into one leaf");
+    assert(small.resolve(anchor) == 1, "anchors survive the collapse");
+    small.insert(0, "x");
+    assert(small.view() == "xad", "the collapsed rope stays editable");
+}